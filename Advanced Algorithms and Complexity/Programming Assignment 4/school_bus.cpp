@@ -1,6 +1,17 @@
 #include <iostream>
 #include <algorithm>
 #include <vector>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <limits>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 using std::vector;
 typedef vector<vector<int> > Matrix;
@@ -20,44 +31,640 @@ Matrix read_data() {
     return graph;
 }
 
-std::pair<int, vector<int> > optimal_path(const Matrix& graph) {
-    // This solution tries all the possible sequences of stops.
-    // It is too slow to pass the problem.
-    // Implement a more efficient algorithm here.
-    size_t n = graph.size();
-    vector<int> p(n);
-    for (size_t i = 0; i < n; ++i)
-        p[i] = i;
-
-    vector<int> best_path;
+// Held-Karp needs a distance and a parent entry for every subset of the stops
+// other than the first one and every stop in it, so it is limited to this many stops.
+const int MAX_HELD_KARP = 22;
+
+// Bytes used by held_karp() for n stops.
+size_t held_karp_memory(int n) {
+    if (n < 2) {
+        return 0;
+    }
+    size_t cells = ((size_t)1 << (n - 1)) * (n - 1);
+    return cells * (sizeof(int) + sizeof(uint8_t)) + ((size_t)1 << (n - 1)) * sizeof(uint32_t);
+}
+
+// Calls f(i) for every i in [0, count) on the given number of threads.
+template <typename F>
+void parallel_for(size_t count, int threads, F f) {
+    const size_t CHUNK = 256;
+    if (threads <= 1 || count <= CHUNK) {
+        for (size_t i = 0; i < count; ++i)
+            f(i);
+        return;
+    }
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t begin = next.fetch_add(CHUNK); begin < count; begin = next.fetch_add(CHUNK)) {
+            size_t end = std::min(count, begin + CHUNK);
+            for (size_t i = begin; i < end; ++i)
+                f(i);
+        }
+    };
+    vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (size_t t = 0; t < pool.size(); ++t)
+        pool[t].join();
+}
+
+// min over k < m of row[k] + col[k]. The entries are at most 2 * INF, which fits in an int.
+inline int min_sum(const int* row, const int* col, int m) {
+    int k = 0;
+    int best = INF;
+#ifdef __AVX2__
+    __m256i best8 = _mm256_set1_epi32(INF);
+    for (; k + 8 <= m; k += 8) {
+        __m256i sum = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(row + k)),
+                                       _mm256_loadu_si256((const __m256i*)(col + k)));
+        best8 = _mm256_min_epi32(best8, sum);
+    }
+    int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, best8);
+    for (int i = 0; i < 8; ++i)
+        best = std::min(best, lanes[i]);
+#endif
+    for (; k < m; ++k)
+        best = std::min(best, row[k] + col[k]);
+    return best;
+}
+
+// Held-Karp dynamic programming over the subsets of the stops 1..n-1, the tour
+// starting and ending at stop 0. dist[S][j] is the length of the shortest path
+// from 0 through all of S ending at j. The subsets are processed layer by layer
+// by size, and the subsets of one layer are independent of each other, so each
+// layer is split between threads. dist[S][k] is INF for k not in S, which turns
+// the minimum over the predecessors into a plain reduction over a row.
+std::pair<int, vector<int> > held_karp(const Matrix& graph, int threads) {
+    int n = graph.size();
+    if (n == 1) {
+        if (graph[0][0] == INF)
+            return std::make_pair(-1, vector<int>());
+        return std::make_pair(graph[0][0], vector<int>(1, 1));
+    }
+
+    int m = n - 1;
+    uint32_t subsets = (uint32_t)1 << m;
+    vector<int> dist((size_t)subsets * m, INF);
+    vector<uint8_t> parent((size_t)subsets * m, 0);
+    // to[j * m + k] = cost of going from stop k + 1 to stop j + 1
+    vector<int> to((size_t)m * m);
+    for (int j = 0; j < m; ++j)
+        for (int k = 0; k < m; ++k)
+            to[j * m + k] = graph[k + 1][j + 1];
+
+    // Subsets ordered by size
+    vector<uint32_t> layer_start(m + 2, 0);
+    for (uint32_t s = 1; s < subsets; ++s)
+        ++layer_start[__builtin_popcount(s) + 1];
+    for (int size = 1; size <= m + 1; ++size)
+        layer_start[size] += layer_start[size - 1];
+    vector<uint32_t> by_size(subsets);
+    vector<uint32_t> fill(layer_start.begin(), layer_start.end() - 1);
+    for (uint32_t s = 1; s < subsets; ++s)
+        by_size[fill[__builtin_popcount(s)]++] = s;
+
+    for (int j = 0; j < m; ++j)
+        dist[((size_t)1 << j) * m + j] = graph[0][j + 1];
+
+    for (int size = 2; size <= m; ++size) {
+        const uint32_t* layer = &by_size[layer_start[size]];
+        parallel_for(layer_start[size + 1] - layer_start[size], threads, [&](size_t i) {
+            uint32_t s = layer[i];
+            for (int j = 0; j < m; ++j) {
+                if (!(s >> j & 1))
+                    continue;
+                uint32_t prev = s ^ ((uint32_t)1 << j);
+                const int* row = &dist[(size_t)prev * m];
+                const int* col = &to[(size_t)j * m];
+                int best = min_sum(row, col, m);
+                if (best >= INF)
+                    continue;
+                int k = 0;
+                while (row[k] + col[k] != best)
+                    ++k;
+                dist[(size_t)s * m + j] = best;
+                parent[(size_t)s * m + j] = k;
+            }
+        });
+    }
+
+    uint32_t full = subsets - 1;
     int best_ans = INF;
+    int last = -1;
+    for (int j = 0; j < m; ++j) {
+        int d = dist[(size_t)full * m + j];
+        if (d < INF && graph[j + 1][0] < INF && d + graph[j + 1][0] < best_ans) {
+            best_ans = d + graph[j + 1][0];
+            last = j;
+        }
+    }
+    if (last < 0)
+        return std::make_pair(-1, vector<int>());
+
+    vector<int> path;
+    for (uint32_t s = full; s; ) {
+        path.push_back(last + 2);
+        int k = parent[(size_t)s * m + last];
+        s ^= (uint32_t)1 << last;
+        last = k;
+    }
+    path.push_back(1);
+    std::reverse(path.begin(), path.end());
+    return std::make_pair(best_ans, path);
+}
+
+// Result of BranchAndBound::solve(). The search may stop at its time limit,
+// in which case the tour is the best one found and lower_bound is the
+// smallest bound among the subproblems left unexplored.
+struct TourResult {
+    // Length of the tour, -1 if no tour was found
+    long long cost;
+    // Stops of the tour, 0-based and starting with 0
+    vector<int> tour;
+    long long lower_bound;
+    bool optimal;
+
+    // Relative distance between the tour and the lower bound
+    double gap() const {
+        if (cost <= 0 || optimal)
+            return 0;
+        return double(cost - lower_bound) / cost;
+    }
+};
+
+// Branch and bound over tours starting at stop 0, extended one stop at a time.
+// The bound of a partial tour is the larger of
+//   - the row and column reduction of the cost matrix restricted to the edges
+//     that can still be used, which also holds for asymmetric matrices, and
+//   - for symmetric matrices, a spanning tree of the unvisited stops plus the
+//     cheapest edges joining it to both ends, with the Held-Karp penalties
+//     computed once on the 1-trees of the whole instance.
+// The first upper bound comes from nearest neighbor followed by 2-opt. Worker
+// threads search depth first from their own deque and steal the shallowest
+// subproblems of the others when theirs runs out.
+class BranchAndBound {
+public:
+    BranchAndBound(const Matrix& graph, int missing, double time_limit_seconds, int threads)
+        : n_(graph.size()), w_((size_t)n_ * n_, NONE), symmetric_(true), pi_(n_, 0.0),
+          time_limit_(time_limit_seconds), threads_(std::max(1, threads)), best_cost_(NONE),
+          pending_(0), stop_(false), dropped_bound_(NONE) {
+        for (int u = 0; u < n_; ++u)
+            for (int v = 0; v < n_; ++v)
+                if (u != v && graph[u][v] < missing)
+                    w_[(size_t)u * n_ + v] = graph[u][v];
+        for (int u = 0; u < n_; ++u)
+            for (int v = 0; v < u; ++v)
+                if (w(u, v) != w(v, u))
+                    symmetric_ = false;
+    }
+
+    TourResult solve() {
+        TourResult result;
+        result.cost = -1;
+        result.lower_bound = 0;
+        result.optimal = true;
+        if (n_ == 0)
+            return result;
+        if (n_ == 1) {
+            result.cost = 0;
+            result.tour.assign(1, 0);
+            return result;
+        }
+        start_ = std::chrono::steady_clock::now();
+
+        warm_start();
+        if (symmetric_)
+            compute_penalties();
+
+        Node root;
+        root.path.push_back(0);
+        root.visited = 1;
+        root.cost = 0;
+        root.bound = bound(root);
+        if (root.bound < best_cost_) {
+            deques_.reset(new WorkerDeque[threads_]);
+            deques_[0].nodes.push_back(root);
+            pending_ = 1;
+            vector<std::thread> pool;
+            for (int t = 1; t < threads_; ++t)
+                pool.emplace_back(&BranchAndBound::work, this, t);
+            work(0);
+            for (size_t t = 0; t < pool.size(); ++t)
+                pool[t].join();
+        }
+
+        if (best_cost_ == NONE) {
+            result.optimal = !stop_;
+            result.lower_bound = result.optimal ? 0 : dropped_bound_.load();
+            return result;
+        }
+        result.cost = best_cost_;
+        result.tour.assign(best_tour_.begin(), best_tour_.end());
+        result.optimal = dropped_bound_ >= best_cost_;
+        result.lower_bound = std::min<long long>(best_cost_, dropped_bound_);
+        return result;
+    }
+
+private:
+    typedef long long Cost;
+    static constexpr Cost NONE = std::numeric_limits<Cost>::max() / 4;
+
+    struct Node {
+        vector<uint8_t> path;
+        uint64_t visited;
+        Cost cost;
+        Cost bound;
+    };
+
+    struct WorkerDeque {
+        std::mutex lock;
+        std::deque<Node> nodes;
+    };
+
+    int n_;
+    vector<Cost> w_;
+    bool symmetric_;
+    // Held-Karp penalties of the stops
+    vector<double> pi_;
+    double time_limit_;
+    int threads_;
+    std::chrono::steady_clock::time_point start_;
+
+    std::mutex best_lock_;
+    std::atomic<Cost> best_cost_;
+    vector<uint8_t> best_tour_;
+
+    std::unique_ptr<WorkerDeque[]> deques_;
+    // Nodes in the deques or being expanded
+    std::atomic<long> pending_;
+    std::atomic<bool> stop_;
+    // Smallest bound of the nodes dropped after the time limit
+    std::atomic<Cost> dropped_bound_;
+
+    Cost w(int u, int v) const {
+        return w_[(size_t)u * n_ + v];
+    }
+
+    Cost tour_cost(const vector<uint8_t>& tour) const {
+        Cost total = 0;
+        for (int i = 0; i < n_; ++i) {
+            Cost c = w(tour[i], tour[(i + 1) % n_]);
+            if (c == NONE)
+                return NONE;
+            total += c;
+        }
+        return total;
+    }
+
+    void offer(const vector<uint8_t>& tour, Cost cost) {
+        std::lock_guard<std::mutex> guard(best_lock_);
+        if (cost < best_cost_) {
+            best_cost_ = cost;
+            best_tour_ = tour;
+        }
+    }
 
-    do {
-        int cur_sum = 0;
-        bool ok = true;
-        for (size_t i = 1; i < n && ok; ++i)
-            if (graph[p[i - 1]][p[i]] == INF)
-                ok = false;
-            else
-                cur_sum += graph[p[i - 1]][p[i]];
-        if (graph[p.back()][p[0]] == INF)
-            ok = false;
-        else
-            cur_sum += graph[p.back()][p[0]];
-
-        if (!ok)
-            continue;
-        if (cur_sum < best_ans) {
-            best_ans = cur_sum;
-            best_path = p;
-        }
-    } while (std::next_permutation(p.begin(), p.end()));
-
-    if (best_ans == INF)
-        best_ans = -1;
-    for (size_t i = 0; i < best_path.size(); ++i)
-        ++best_path[i];
-    return std::make_pair(best_ans, best_path);
+    static void lower_to(std::atomic<Cost>& value, Cost candidate) {
+        Cost current = value.load();
+        while (candidate < current && !value.compare_exchange_weak(current, candidate)) {
+        }
+    }
+
+    // Nearest neighbor tour from stop 0, improved by 2-opt moves while they help.
+    void warm_start() {
+        vector<uint8_t> tour(1, 0);
+        uint64_t visited = 1;
+        for (int step = 1; step < n_; ++step) {
+            int last = tour.back();
+            int next = -1;
+            for (int v = 0; v < n_; ++v)
+                if (!(visited >> v & 1) && w(last, v) != NONE && (next < 0 || w(last, v) < w(last, next)))
+                    next = v;
+            if (next < 0)
+                return;
+            tour.push_back(next);
+            visited |= (uint64_t)1 << next;
+        }
+        Cost cost = tour_cost(tour);
+        if (cost == NONE)
+            return;
+
+        bool improved = true;
+        while (improved && !out_of_time()) {
+            improved = false;
+            for (int i = 1; i + 1 < n_; ++i) {
+                for (int j = i + 1; j < n_; ++j) {
+                    std::reverse(tour.begin() + i, tour.begin() + j + 1);
+                    Cost candidate = tour_cost(tour);
+                    if (candidate < cost) {
+                        cost = candidate;
+                        improved = true;
+                    } else {
+                        std::reverse(tour.begin() + i, tour.begin() + j + 1);
+                    }
+                }
+            }
+        }
+        offer(tour, cost);
+    }
+
+    // Weight of the minimum 1-tree under the penalties pi_, with stop 0 as the
+    // special node, and the degree of every stop in it. NONE if there is none.
+    double one_tree(vector<int>& degree) const {
+        degree.assign(n_, 0);
+        vector<double> key(n_, 1e300);
+        vector<int> from(n_, -1);
+        vector<char> in_tree(n_, false);
+        double total = 0;
+        key[1] = 0;
+        for (int step = 1; step < n_; ++step) {
+            int u = -1;
+            for (int v = 1; v < n_; ++v)
+                if (!in_tree[v] && (u < 0 || key[v] < key[u]))
+                    u = v;
+            if (key[u] >= 1e300)
+                return NONE;
+            in_tree[u] = true;
+            total += key[u];
+            if (from[u] >= 0) {
+                ++degree[u];
+                ++degree[from[u]];
+            }
+            for (int v = 1; v < n_; ++v) {
+                if (!in_tree[v] && w(u, v) != NONE && w(u, v) + pi_[u] + pi_[v] < key[v]) {
+                    key[v] = w(u, v) + pi_[u] + pi_[v];
+                    from[v] = u;
+                }
+            }
+        }
+        // The two cheapest edges of stop 0
+        int first = -1, second = -1;
+        for (int v = 1; v < n_; ++v) {
+            if (w(0, v) == NONE)
+                continue;
+            double c = w(0, v) + pi_[v];
+            if (first < 0 || c < w(0, first) + pi_[first]) {
+                second = first;
+                first = v;
+            } else if (second < 0 || c < w(0, second) + pi_[second]) {
+                second = v;
+            }
+        }
+        if (second < 0)
+            return NONE;
+        total += w(0, first) + pi_[first] + w(0, second) + pi_[second] + 2 * pi_[0];
+        degree[0] = 2;
+        ++degree[first];
+        ++degree[second];
+        for (int v = 0; v < n_; ++v)
+            total -= 2 * pi_[v];
+        return total;
+    }
+
+    // Subgradient ascent on the penalties, keeping the ones with the best 1-tree bound.
+    void compute_penalties() {
+        if (n_ < 3 || best_cost_ == NONE)
+            return;
+        vector<double> best_pi = pi_;
+        double best_bound = -1e300;
+        double lambda = 2;
+        int since_improvement = 0;
+        vector<int> degree;
+        for (int iteration = 0; iteration < 50 * n_ && lambda > 1e-6 && !out_of_time(); ++iteration) {
+            double value = one_tree(degree);
+            if (value == NONE)
+                return;
+            if (value > best_bound + 1e-9) {
+                best_bound = value;
+                best_pi = pi_;
+                since_improvement = 0;
+            } else if (++since_improvement >= n_ / 2 + 1) {
+                lambda /= 2;
+                since_improvement = 0;
+            }
+            double norm = 0;
+            for (int v = 0; v < n_; ++v)
+                norm += (degree[v] - 2) * (degree[v] - 2);
+            if (norm == 0)
+                break;  // the 1-tree is a tour
+            double step = lambda * (best_cost_ - value) / norm;
+            for (int v = 0; v < n_; ++v)
+                pi_[v] += step * (degree[v] - 2);
+        }
+        pi_ = best_pi;
+    }
+
+    // Row and column reduction bound on completing the path: every stop in
+    // `rows` still has to be left and every stop in `cols` still has to be entered.
+    Cost reduction_bound(const Node& node, const vector<int>& rest) const {
+        int last = node.path.back();
+        vector<int> rows(1, last), cols(1, 0);
+        rows.insert(rows.end(), rest.begin(), rest.end());
+        cols.insert(cols.end(), rest.begin(), rest.end());
+
+        Cost total = 0;
+        vector<Cost> row_min(rows.size(), NONE);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            for (size_t j = 0; j < cols.size(); ++j)
+                if (allowed(rows[i], cols[j], last, rest.empty()))
+                    row_min[i] = std::min(row_min[i], w(rows[i], cols[j]));
+            if (row_min[i] == NONE)
+                return NONE;
+            total += row_min[i];
+        }
+        for (size_t j = 0; j < cols.size(); ++j) {
+            Cost col_min = NONE;
+            for (size_t i = 0; i < rows.size(); ++i)
+                if (allowed(rows[i], cols[j], last, rest.empty()))
+                    col_min = std::min(col_min, w(rows[i], cols[j]) - row_min[i]);
+            if (col_min == NONE)
+                return NONE;
+            total += col_min;
+        }
+        return total;
+    }
+
+    // Whether the edge u -> v can still be part of the tour
+    bool allowed(int u, int v, int last, bool last_step) const {
+        if (u == v || w(u, v) == NONE)
+            return false;
+        // The path goes back to 0 from last only after all the other stops
+        return !(u == last && v == 0 && !last_step);
+    }
+
+    // Spanning tree of the unvisited stops plus the cheapest edges from the
+    // last stop into them and from them back to 0, under the penalties pi_.
+    Cost path_tree_bound(const Node& node, const vector<int>& rest) const {
+        int last = node.path.back();
+        if (rest.empty())
+            return w(last, 0);
+        double total = -pi_[last] - pi_[0];
+        double enter = 1e300, leave = 1e300;
+        for (int v : rest) {
+            total -= 2 * pi_[v];
+            if (w(last, v) != NONE)
+                enter = std::min(enter, w(last, v) + pi_[last] + pi_[v]);
+            if (w(v, 0) != NONE)
+                leave = std::min(leave, w(v, 0) + pi_[v] + pi_[0]);
+        }
+        if (enter >= 1e300 || leave >= 1e300)
+            return NONE;
+        total += enter + leave;
+
+        size_t k = rest.size();
+        vector<double> key(k, 1e300);
+        vector<char> in_tree(k, false);
+        key[0] = 0;
+        for (size_t step = 0; step < k; ++step) {
+            size_t u = k;
+            for (size_t i = 0; i < k; ++i)
+                if (!in_tree[i] && (u == k || key[i] < key[u]))
+                    u = i;
+            if (key[u] >= 1e300)
+                return NONE;
+            in_tree[u] = true;
+            total += key[u];
+            for (size_t i = 0; i < k; ++i) {
+                Cost c = w(rest[u], rest[i]);
+                if (!in_tree[i] && c != NONE)
+                    key[i] = std::min(key[i], c + pi_[rest[u]] + pi_[rest[i]]);
+            }
+        }
+        // Rounded up, allowing for the error of the penalties
+        double rounded = total - 1e-6;
+        Cost result = (Cost)rounded;
+        return result < rounded ? result + 1 : result;
+    }
+
+    Cost bound(const Node& node) const {
+        vector<int> rest;
+        for (int v = 0; v < n_; ++v)
+            if (!(node.visited >> v & 1))
+                rest.push_back(v);
+        Cost reduced = reduction_bound(node, rest);
+        if (reduced == NONE)
+            return NONE;
+        Cost result = node.cost + reduced;
+        if (symmetric_) {
+            Cost tree = path_tree_bound(node, rest);
+            if (tree == NONE)
+                return NONE;
+            result = std::max(result, node.cost + tree);
+        }
+        return result;
+    }
+
+    bool out_of_time() const {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_;
+        return elapsed.count() > time_limit_;
+    }
+
+    bool pop_own(int id, Node& node) {
+        std::lock_guard<std::mutex> guard(deques_[id].lock);
+        if (deques_[id].nodes.empty())
+            return false;
+        node = std::move(deques_[id].nodes.back());
+        deques_[id].nodes.pop_back();
+        return true;
+    }
+
+    bool steal(int id, Node& node) {
+        for (int i = 1; i < threads_; ++i) {
+            WorkerDeque& victim = deques_[(id + i) % threads_];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.nodes.empty()) {
+                node = std::move(victim.nodes.front());
+                victim.nodes.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(int id) {
+        Node node;
+        long expanded = 0;
+        while (true) {
+            if (!pop_own(id, node) && !steal(id, node)) {
+                if (pending_ == 0)
+                    return;
+                std::this_thread::yield();
+                continue;
+            }
+            if (++expanded % 256 == 0 && out_of_time())
+                stop_ = true;
+            if (stop_) {
+                if (node.bound < best_cost_)
+                    lower_to(dropped_bound_, node.bound);
+            } else if (node.bound < best_cost_) {
+                expand(id, node);
+            }
+            --pending_;
+        }
+    }
+
+    void expand(int id, const Node& node) {
+        int last = node.path.back();
+        if ((int)node.path.size() == n_) {
+            Cost back = w(last, 0);
+            if (back != NONE && node.cost + back < best_cost_)
+                offer(node.path, node.cost + back);
+            return;
+        }
+        vector<Node> children;
+        for (int v = 0; v < n_; ++v) {
+            if ((node.visited >> v & 1) || w(last, v) == NONE)
+                continue;
+            Node child;
+            child.path = node.path;
+            child.path.push_back(v);
+            child.visited = node.visited | (uint64_t)1 << v;
+            child.cost = node.cost + w(last, v);
+            child.bound = bound(child);
+            if (child.bound < best_cost_)
+                children.push_back(std::move(child));
+        }
+        // The most promising child is pushed last, so it is expanded next
+        std::sort(children.begin(), children.end(),
+                  [](const Node& a, const Node& b) { return a.bound > b.bound; });
+        pending_ += children.size();
+        std::lock_guard<std::mutex> guard(deques_[id].lock);
+        for (size_t i = 0; i < children.size(); ++i)
+            deques_[id].nodes.push_back(std::move(children[i]));
+    }
+};
+
+constexpr long long BranchAndBound::NONE;
+
+// Time given to the branch and bound search on instances too large for Held-Karp.
+// If it runs out, the best tour found so far is printed.
+const double BRANCH_AND_BOUND_SECONDS = 60;
+
+std::pair<int, vector<int> > optimal_path(const Matrix& graph) {
+    int n = graph.size();
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    if (n <= MAX_HELD_KARP) {
+        std::cerr << "Held-Karp on " << n << " stops needs "
+                  << (held_karp_memory(n) + (1 << 20) - 1) / (1 << 20) << " MB\n";
+        return held_karp(graph, threads);
+    }
+    if (n > 64) {
+        std::cerr << n << " stops is above the branch and bound limit of 64\n";
+        return std::make_pair(-1, vector<int>());
+    }
+
+    TourResult result = BranchAndBound(graph, INF, BRANCH_AND_BOUND_SECONDS, threads).solve();
+    if (!result.optimal)
+        std::cerr << "Time limit reached, the tour is within " << 100 * result.gap()
+                  << "% of the optimum (lower bound " << result.lower_bound << ")\n";
+    if (result.cost < 0)
+        return std::make_pair(-1, vector<int>());
+    vector<int> path(result.tour);
+    for (size_t i = 0; i < path.size(); ++i)
+        ++path[i];
+    return std::make_pair((int)result.cost, path);
 }
 
 void print_answer(const std::pair<int, vector<int> >& answer) {
@@ -1,55 +1,452 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 using std::string;
+using std::vector;
 
 int min(int x, int y, int z) {
     int res = (x <= y ? x : y);
     return (z < res ? z : res);
 }
 
-int edit_distance(string &str1, string &str2) {
+// Plain dynamic programming, keeping one row over the shorter string.
+int edit_distance_two_rows(const string &str1, const string &str2) {
+    const string &cols = str1.length() <= str2.length() ? str1 : str2;
+    const string &rows = str1.length() <= str2.length() ? str2 : str1;
+    int n = cols.length();
+    int m = rows.length();
 
-    int n = str1.length();
-    int m = str2.length();
+    vector<int> prev(n + 1), cur(n + 1);
 
-    //prepend whitespace to strings to avoid offset indeces.
-    str1.insert(0, 1, ' ');
-    str2.insert(0, 1, ' ');
-
-    int dp_table[m + 1][n + 1];
-    dp_table[0][0] = 0;
+    for (int j = 0; j <= n; ++j) {
+        prev[j] = j;
+    }
 
     for (int i = 1; i <= m; ++i) {
-        dp_table[i][0] = i;
+        cur[0] = i;
+        for (int j = 1; j <= n; ++j) {
+            int ins = cur[j - 1] + 1;
+            int del = prev[j] + 1;
+            int sub = prev[j - 1] + (cols[j - 1] == rows[i - 1] ? 0 : 1);
+            cur[j] = min(ins, del, sub);
+        }
+        prev.swap(cur);
     }
 
-    for (int j = 1; j <= n; ++j) {
-        dp_table[0][j] = j;
+    return prev[n];
+}
+
+// Myers' bit-vector algorithm in Hyyro's block form: the column of the table
+// under each character of the text is kept as bit vectors of its +1 and -1
+// vertical deltas, 64 rows of the pattern per word, and the carry between
+// words is the horizontal delta at the block boundary. The pattern is the
+// shorter string, so the time is O(ceil(m / 64) n) and the memory one word
+// pair per block plus the match masks of the characters in the pattern.
+class MyersDistance {
+public:
+    explicit MyersDistance(const string &pattern)
+        : m_(pattern.length()), blocks_((pattern.length() + 63) / 64), symbol_() {
+        int symbols = 1;
+        for (unsigned char c : pattern) {
+            if (symbol_[c] == 0) {
+                symbol_[c] = symbols++;
+            }
+        }
+        // symbol 0 stands for the characters missing from the pattern
+        peq_.assign(symbols * blocks_, 0);
+        for (size_t i = 0; i < m_; ++i) {
+            int s = symbol_[static_cast<unsigned char>(pattern[i])];
+            peq_[s * blocks_ + i / 64] |= uint64_t(1) << (i % 64);
+        }
     }
 
-    for (int i = 1; i <= m; ++i) {
-        for (int j = 1; j <= n; ++j) {
+    int distance(const string &text) const {
+        if (m_ == 0) {
+            return text.length();
+        }
+
+        int last = (m_ - 1) % 64;
+        int score = m_;
+
+        if (blocks_ == 1) {
+            uint64_t pv = ~uint64_t(0), mv = 0;
+            for (unsigned char c : text) {
+                uint64_t hp = 1, hm = 0;
+                advance(pv, mv, peq_[symbol_[c]], hp, hm, last);
+                score += int(hp) - int(hm);
+            }
+            return score;
+        }
+
+        vector<uint64_t> pv(blocks_, ~uint64_t(0)), mv(blocks_, 0);
+
+        for (unsigned char c : text) {
+            const uint64_t *eq = &peq_[symbol_[c] * blocks_];
+            // the top row of a global alignment grows by one per column
+            uint64_t hp = 1, hm = 0;
+            for (size_t b = 0; b + 1 < blocks_; ++b) {
+                advance(pv[b], mv[b], eq[b], hp, hm, 63);
+            }
+            advance(pv[blocks_ - 1], mv[blocks_ - 1], eq[blocks_ - 1], hp, hm, last);
+            score += int(hp) - int(hm);
+        }
+
+        return score;
+    }
+
+private:
+    size_t m_;
+    size_t blocks_;
+    unsigned short symbol_[256];
+    vector<uint64_t> peq_;
 
-            int ins = dp_table[i][j - 1] + 1;
-            int del = dp_table[i - 1][j] + 1;
-            int mch = dp_table[i - 1][j - 1];
-            int mis = dp_table[i - 1][j - 1] + 1;
+    // Moves one block to the next column. hp and hm hold the horizontal
+    // delta entering its top row as +1 and -1 bits, and are replaced by the
+    // one leaving row out.
+    static void advance(uint64_t &pv, uint64_t &mv, uint64_t eq, uint64_t &hp, uint64_t &hm, int out) {
+        uint64_t xv = eq | mv;
+        eq |= hm;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
 
-            dp_table[i][j] = (str1[j] == str2[i] ?
-                                min(ins, del, mch) :
-                                min(ins, del, mis));
+        uint64_t hp_in = hp, hm_in = hm;
+        hp = (ph >> out) & 1;
+        hm = (mh >> out) & 1;
 
+        ph = (ph << 1) | hp_in;
+        mh = (mh << 1) | hm_in;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+};
+
+// Edit distance if it is at most k, k + 1 otherwise, filling only the
+// diagonals within k of the main one: O(k min(n, m)) time and O(k) memory.
+int edit_distance_banded(const string &str1, const string &str2, int k) {
+    const string &cols = str1.length() <= str2.length() ? str1 : str2;
+    const string &rows = str1.length() <= str2.length() ? str2 : str1;
+    int n = cols.length();
+    int m = rows.length();
+    int cap = k + 1;
+
+    if (m - n > k) {
+        return cap;
+    }
+
+    // cur[d] is the cell of the current row on diagonal j - i = d - k - 1,
+    // and the border entries 0 and width + 1 stay at cap
+    int width = 2 * k + 1;
+    vector<int> prev(width + 2, cap), cur(width + 2, cap);
+
+    for (int j = 0; j <= std::min(n, k); ++j) {
+        prev[j + k + 1] = j;
+    }
+
+    for (int i = 1; i <= m; ++i) {
+        int best = cap;
+        int lo = std::max(0, i - k);
+        int hi = std::min(n, i + k);
+        for (int j = lo; j <= hi; ++j) {
+            int d = j - i + k + 1;
+            int value;
+            if (j == 0) {
+                value = i;
+            } else {
+                int ins = cur[d - 1] + 1;
+                int del = prev[d + 1] + 1;
+                int sub = prev[d] + (cols[j - 1] == rows[i - 1] ? 0 : 1);
+                value = min(ins, del, sub);
+            }
+            cur[d] = std::min(value, cap);
+            best = std::min(best, cur[d]);
+        }
+        if (best == cap) {
+            return cap;
         }
+        prev.swap(cur);
     }
 
-    return dp_table[m][n];
+    return prev[n - m + k + 1];
+}
+
+// Edit distance, or with max_distance >= 0 the distance capped at
+// max_distance + 1. A word of the bit-vector columns costs about as much as
+// a cell of the band, so the band is only used when it is the narrower.
+int edit_distance(const string &str1, const string &str2, int max_distance = -1) {
+    const string &shorter = str1.length() <= str2.length() ? str1 : str2;
+    const string &longer = str1.length() <= str2.length() ? str2 : str1;
+
+    if (max_distance < 0) {
+        return MyersDistance(shorter).distance(longer);
+    }
+    if (longer.length() - shorter.length() > size_t(max_distance)) {
+        return max_distance + 1;
+    }
+    if ((shorter.length() + 63) / 64 > size_t(2 * max_distance + 1)) {
+        return edit_distance_banded(shorter, longer, max_distance);
+    }
+    return std::min(MyersDistance(shorter).distance(longer), max_distance + 1);
+}
+
+// Costs of an alignment: a gap of length k costs gap_open + k * gap_extend,
+// and matches cost nothing. The defaults give the edit distance.
+struct AlignmentCosts {
+    int mismatch = 1;
+    int gap_open = 0;
+    int gap_extend = 1;
+};
+
+// Cost of the alignment of a and b given by an edit script of 'M' (match),
+// 'X' (mismatch), 'D' (character of a deleted) and 'I' (character of b
+// inserted), where each run of D or I is one gap.
+int script_cost(const string &script, const AlignmentCosts &costs) {
+    int cost = 0;
+    for (size_t i = 0; i < script.length(); ++i) {
+        if (script[i] == 'X') {
+            cost += costs.mismatch;
+        } else if (script[i] == 'D' || script[i] == 'I') {
+            if (i == 0 || script[i - 1] != script[i]) {
+                cost += costs.gap_open;
+            }
+            cost += costs.gap_extend;
+        }
+    }
+    return cost;
 }
 
-int main() {
+// Optimal alignment in O(n + m) space by Myers and Miller's version of
+// Hirschberg's divide and conquer for Gotoh's affine-gap recurrences. Each
+// split scores the top half of a forwards and the bottom half backwards,
+// keeping for every column the best cost and the best cost ending in a
+// deletion, and cuts b where the two meet cheapest, either between two rows
+// or inside a deletion that crosses them. tb and te are the costs of opening
+// a deletion at the top and the bottom of a subproblem, zero when it
+// continues one from its neighbour. The two passes of a split, and then the
+// two subproblems, run in parallel while threads are left.
+class Aligner {
+public:
+    Aligner(const string &a, const string &b, const AlignmentCosts &costs)
+        : a_(a), b_(b), costs_(costs) {}
+
+    string align(int threads) const {
+        string script;
+        diff(0, a_.length(), 0, b_.length(), costs_.gap_open, costs_.gap_open, threads, script);
+        return script;
+    }
+
+private:
+    // Splits smaller than this many cells are not worth a thread.
+    static const size_t PARALLEL_CELLS = size_t(1) << 20;
+
+    const string &a_;
+    const string &b_;
+    AlignmentCosts costs_;
+
+    int gap(size_t length) const {
+        return length == 0 ? 0 : costs_.gap_open + costs_.gap_extend * int(length);
+    }
+
+    // Scores rows of a against b, both read from the given ends in the given
+    // direction, with t the cost of opening a deletion on the top boundary.
+    // cc[j] is the best cost of the rows against the first j columns, and
+    // dd[j] the best one ending in a deletion.
+    void pass(const char *a, long a_step, size_t rows, const char *b, long b_step, size_t cols,
+              int t, vector<int> &cc, vector<int> &dd) const {
+        int g = costs_.gap_open, h = costs_.gap_extend, x = costs_.mismatch;
+        cc.assign(cols + 1, 0);
+        dd.assign(cols + 1, 0);
+
+        int u = g;
+        for (size_t j = 1; j <= cols; ++j) {
+            u += h;
+            cc[j] = u;
+            dd[j] = u + g;
+        }
+
+        for (size_t i = 1; i <= rows; ++i) {
+            char ai = a[long(i - 1) * a_step];
+            int s = cc[0];
+            t += h;
+            int c = t;
+            int e = t + g;
+            cc[0] = c;
+            for (size_t j = 1; j <= cols; ++j) {
+                e = std::min(e, c + g) + h;
+                dd[j] = std::min(dd[j], cc[j] + g) + h;
+                c = std::min(std::min(dd[j], e), s + (ai == b[long(j - 1) * b_step] ? 0 : x));
+                s = cc[j];
+                cc[j] = c;
+            }
+        }
+
+        dd[0] = cc[0];
+    }
+
+    void diff(size_t a0, size_t m, size_t b0, size_t n, int tb, int te, int threads,
+              string &script) const {
+        if (n == 0) {
+            script.append(m, 'D');
+            return;
+        }
+        if (m == 0) {
+            script.append(n, 'I');
+            return;
+        }
+        if (m == 1) {
+            single_row(a0, b0, n, tb, te, script);
+            return;
+        }
+
+        size_t mid = m / 2;
+        bool parallel = threads > 1 && m * n >= PARALLEL_CELLS;
+        vector<int> cc, dd, rr, ss;
+
+        if (parallel) {
+            std::thread top([&] {
+                pass(&a_[a0], 1, mid, &b_[b0], 1, n, tb, cc, dd);
+            });
+            pass(&a_[a0 + m - 1], -1, m - mid, &b_[b0 + n - 1], -1, n, te, rr, ss);
+            top.join();
+        } else {
+            pass(&a_[a0], 1, mid, &b_[b0], 1, n, tb, cc, dd);
+            pass(&a_[a0 + m - 1], -1, m - mid, &b_[b0 + n - 1], -1, n, te, rr, ss);
+        }
+
+        size_t split = 0;
+        bool crossing = false;
+        int best = cc[0] + rr[n];
+        for (size_t j = 0; j <= n; ++j) {
+            if (cc[j] + rr[n - j] < best) {
+                best = cc[j] + rr[n - j];
+                split = j;
+                crossing = false;
+            }
+            if (dd[j] + ss[n - j] - costs_.gap_open < best) {
+                best = dd[j] + ss[n - j] - costs_.gap_open;
+                split = j;
+                crossing = true;
+            }
+        }
+
+        vector<int>().swap(cc);
+        vector<int>().swap(dd);
+        vector<int>().swap(rr);
+        vector<int>().swap(ss);
+
+        // the left part goes straight into script, the right one after it
+        string tail;
+        int left_threads = parallel ? threads / 2 : 1;
+        int right_threads = parallel ? threads - left_threads : threads;
+        auto left = [&] {
+            if (crossing) {
+                diff(a0, mid - 1, b0, split, tb, 0, left_threads, script);
+                script += "DD";
+            } else {
+                diff(a0, mid, b0, split, tb, costs_.gap_open, left_threads, script);
+            }
+        };
+        auto right = [&] {
+            if (crossing) {
+                diff(a0 + mid + 1, m - mid - 1, b0 + split, n - split, 0, te, right_threads, tail);
+            } else {
+                diff(a0 + mid, m - mid, b0 + split, n - split, costs_.gap_open, te, right_threads, tail);
+            }
+        };
+
+        if (parallel) {
+            std::thread worker(left);
+            right();
+            worker.join();
+        } else {
+            left();
+            right();
+        }
+        script += tail;
+    }
+
+    // One character of a against b[b0, b0 + n): either deleted, joining
+    // whichever boundary gap is cheaper to open, or aligned with the b[j]
+    // that costs the least.
+    void single_row(size_t a0, size_t b0, size_t n, int tb, int te, string &script) const {
+        int best = std::min(tb, te) + costs_.gap_extend + gap(n);
+        size_t match = n;
+        for (size_t j = 0; j < n; ++j) {
+            int cost = gap(j) + (a_[a0] == b_[b0 + j] ? 0 : costs_.mismatch) + gap(n - j - 1);
+            if (cost < best) {
+                best = cost;
+                match = j;
+            }
+        }
+
+        if (match < n) {
+            script.append(match, 'I');
+            script += a_[a0] == b_[b0 + match] ? 'M' : 'X';
+            script.append(n - match - 1, 'I');
+        } else if (tb <= te) {
+            script += 'D';
+            script.append(n, 'I');
+        } else {
+            script.append(n, 'I');
+            script += 'D';
+        }
+    }
+};
+
+const size_t Aligner::PARALLEL_CELLS;
+
+// Usage: edit_distance [--max K | --two-rows]
+//        edit_distance --align [--mismatch X] [--gap-open G] [--gap-extend E] [--threads N]
+// Prints the edit distance of each pair of strings read, or with --max the
+// distance capped at K + 1 once it exceeds K. With --align, prints the cost
+// of an optimal alignment under the given costs and its edit script.
+int main(int argc, char **argv) {
+    std::ios_base::sync_with_stdio(false);
+    int max_distance = -1;
+    bool two_rows = false;
+    bool align = false;
+    AlignmentCosts costs;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--max" && i + 1 < argc) {
+            max_distance = atoi(argv[++i]);
+        } else if (arg == "--two-rows") {
+            two_rows = true;
+        } else if (arg == "--align") {
+            align = true;
+        } else if (arg == "--mismatch" && i + 1 < argc) {
+            costs.mismatch = atoi(argv[++i]);
+        } else if (arg == "--gap-open" && i + 1 < argc) {
+            costs.gap_open = atoi(argv[++i]);
+        } else if (arg == "--gap-extend" && i + 1 < argc) {
+            costs.gap_extend = atoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::max(1, atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: edit_distance [--max K | --two-rows]\n"
+                      << "       edit_distance --align [--mismatch X] [--gap-open G]"
+                      << " [--gap-extend E] [--threads N]" << std::endl;
+            return 1;
+        }
+    }
+
     string str1;
     string str2;
-    std::cin >> str1 >> str2;
-    std::cout << edit_distance(str1, str2) << std::endl;
+    while (std::cin >> str1 >> str2) {
+        if (align) {
+            string script = Aligner(str1, str2, costs).align(threads);
+            std::cout << script_cost(script, costs) << '\n' << script << '\n';
+            continue;
+        }
+        int distance = two_rows ? edit_distance_two_rows(str1, str2)
+                                : edit_distance(str1, str2, max_distance);
+        std::cout << distance << '\n';
+    }
     return 0;
 }
@@ -1,14 +1,251 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <string>
+#include <thread>
 #include <vector>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 using std::vector;
 
+// Lengths of the longest common subsequences of rows elements of a against
+// every prefix of b, both read from the given ends in the given direction:
+// len[j] is the length for the first j elements of b.
+void lcs_row(const int *a, long a_step, size_t rows, const int *b, long b_step, size_t cols,
+             vector<int> &len) {
+  len.assign(cols + 1, 0);
+  for (size_t i = 0; i < rows; ++i) {
+    int ai = a[long(i) * a_step];
+    int diagonal = 0;
+    for (size_t j = 1; j <= cols; ++j) {
+      int up = len[j];
+      len[j] = ai == b[long(j - 1) * b_step] ? diagonal + 1 : std::max(up, len[j - 1]);
+      diagonal = up;
+    }
+  }
+}
+
+// Hirschberg's divide and conquer: the top half of a is scored forwards and
+// the bottom half backwards against b, b is cut where the two sums peak, and
+// both sides recurse, so only two rows are alive per level. The two passes
+// of a split, and then the two subproblems, run in parallel while threads
+// are left.
+class LcsAligner {
+public:
+  LcsAligner(const vector<int> &a, const vector<int> &b) : a_(a), b_(b) {}
+
+  vector<int> common_subsequence(int threads) const {
+    vector<int> result;
+    solve(0, a_.size(), 0, b_.size(), threads, result);
+    return result;
+  }
+
+private:
+  // Splits smaller than this many cells are not worth a thread.
+  static const size_t PARALLEL_CELLS = size_t(1) << 20;
+
+  const vector<int> &a_;
+  const vector<int> &b_;
+
+  void solve(size_t a0, size_t m, size_t b0, size_t n, int threads, vector<int> &result) const {
+    if (m == 0 || n == 0) {
+      return;
+    }
+    if (m == 1) {
+      if (std::find(b_.begin() + b0, b_.begin() + b0 + n, a_[a0]) != b_.begin() + b0 + n) {
+        result.push_back(a_[a0]);
+      }
+      return;
+    }
+
+    size_t mid = m / 2;
+    bool parallel = threads > 1 && m * n >= PARALLEL_CELLS;
+    vector<int> forward, backward;
+
+    if (parallel) {
+      std::thread top([&] {
+        lcs_row(&a_[a0], 1, mid, &b_[b0], 1, n, forward);
+      });
+      lcs_row(&a_[a0 + m - 1], -1, m - mid, &b_[b0 + n - 1], -1, n, backward);
+      top.join();
+    } else {
+      lcs_row(&a_[a0], 1, mid, &b_[b0], 1, n, forward);
+      lcs_row(&a_[a0 + m - 1], -1, m - mid, &b_[b0 + n - 1], -1, n, backward);
+    }
+
+    size_t split = 0;
+    for (size_t j = 1; j <= n; ++j) {
+      if (forward[j] + backward[n - j] > forward[split] + backward[n - split]) {
+        split = j;
+      }
+    }
+    vector<int>().swap(forward);
+    vector<int>().swap(backward);
+
+    // the left part goes straight into result, the right one after it
+    vector<int> tail;
+    if (parallel) {
+      std::thread left([&] {
+        solve(a0, mid, b0, split, threads / 2, result);
+      });
+      solve(a0 + mid, m - mid, b0 + split, n - split, threads - threads / 2, tail);
+      left.join();
+    } else {
+      solve(a0, mid, b0, split, threads, result);
+      solve(a0 + mid, m - mid, b0 + split, n - split, threads, tail);
+    }
+    result.insert(result.end(), tail.begin(), tail.end());
+  }
+};
+
+const size_t LcsAligner::PARALLEL_CELLS;
+
+// LCS length by anti-diagonals: the cells with i + j = d depend only on the
+// two diagonals before, so each diagonal is one independent sweep, 8 cells
+// per AVX2 instruction. b is stored reversed so that the elements compared
+// along a diagonal are contiguous, and three diagonals of |a| + 1 cells are
+// the whole memory.
+int lcs_wavefront(const vector<int> &a, const vector<int> &b) {
+  int m = a.size(), n = b.size();
+  vector<int> reversed(b.rbegin(), b.rend());
+  vector<int> before(m + 1, 0), last(m + 1, 0), cur(m + 1, 0);
+
+  for (int d = 2; d <= m + n; ++d) {
+    int lo = std::max(1, d - n), hi = std::min(m, d - 1);
+    // cur[i] is the cell (i, d - i), before and last are diagonals d - 2
+    // and d - 1, and reversed[n - d + i] is b[d - i - 1]
+    int shift = n - d;
+    int i = lo;
+#ifdef __AVX2__
+    const __m256i one = _mm256_set1_epi32(1);
+    for (; i + 8 <= hi + 1; i += 8) {
+      __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&a[i - 1]));
+      __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&reversed[shift + i]));
+      __m256i diagonal = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&before[i - 1]));
+      __m256i up = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&last[i - 1]));
+      __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&last[i]));
+      __m256i value = _mm256_blendv_epi8(_mm256_max_epi32(up, left),
+                                         _mm256_add_epi32(diagonal, one),
+                                         _mm256_cmpeq_epi32(x, y));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(&cur[i]), value);
+    }
+#endif
+    for (; i <= hi; ++i) {
+      cur[i] = a[i - 1] == reversed[shift + i] ? before[i - 1] + 1 : std::max(last[i - 1], last[i]);
+    }
+    // the cells on the borders of the table stay 0
+    if (d <= n) {
+      cur[0] = 0;
+    }
+    if (d <= m) {
+      cur[d] = 0;
+    }
+    before.swap(last);
+    last.swap(cur);
+  }
+
+  return m > 0 && n > 0 ? last[m] : 0;
+}
+
+// Bit-parallel LCS (Allison and Dix, in Hyyro's form): a column of the table
+// over b is kept as a bit vector whose zeros mark the rows where the length
+// grows, and each element x of a updates it with
+//   V = (V + (V & M[x])) | (V & ~M[x]),
+// where M[x] marks the positions of x in b. The addition carries across
+// words, so a step costs |b| / 64 word operations whatever the alphabet, and
+// the masks take one bit per element of b and distinct value in it.
+class BitParallelLcs {
+public:
+  explicit BitParallelLcs(const vector<int> &b)
+      : n_(b.size()), words_((b.size() + 63) / 64), values_(b) {
+    std::sort(values_.begin(), values_.end());
+    values_.erase(std::unique(values_.begin(), values_.end()), values_.end());
+    masks_.assign(values_.size() * words_, 0);
+    for (size_t j = 0; j < n_; ++j) {
+      size_t x = std::lower_bound(values_.begin(), values_.end(), b[j]) - values_.begin();
+      masks_[x * words_ + j / 64] |= uint64_t(1) << (j % 64);
+    }
+  }
+
+  // Words of masks needed for b, to decide whether this is worth building
+  static size_t mask_words(const vector<int> &b) {
+    vector<int> values(b);
+    std::sort(values.begin(), values.end());
+    return (std::unique(values.begin(), values.end()) - values.begin()) * ((b.size() + 63) / 64);
+  }
+
+  int length(const vector<int> &a) const {
+    // padding bits above n_ never see a match and stay set
+    vector<uint64_t> v(words_, ~uint64_t(0));
+    for (int x : a) {
+      vector<int>::const_iterator it = std::lower_bound(values_.begin(), values_.end(), x);
+      if (it == values_.end() || *it != x) {
+        continue;
+      }
+      const uint64_t *mask = &masks_[(it - values_.begin()) * words_];
+      uint64_t carry = 0;
+      for (size_t w = 0; w < words_; ++w) {
+        uint64_t u = v[w] & mask[w];
+        uint64_t sum = v[w] + u;
+        uint64_t next = sum < u;
+        sum += carry;
+        next |= sum < carry;
+        v[w] = sum | (v[w] & ~mask[w]);
+        carry = next;
+      }
+    }
+
+    int zeros = 0;
+    for (size_t w = 0; w < words_; ++w) {
+      zeros += __builtin_popcountll(~v[w]);
+    }
+    return zeros;
+  }
+
+private:
+  size_t n_;
+  size_t words_;
+  vector<int> values_;
+  vector<uint64_t> masks_;
+};
+
+// Masks beyond this many words cost more memory than the wavefront.
+const size_t MAX_MASK_WORDS = size_t(1) << 22;
+
 int lcs2(vector<int> &a, vector<int> &b) {
-  //write your code here
-  return std::min(std::min(a.size(), b.size()), c.size());
+  const vector<int> &longer = a.size() >= b.size() ? a : b;
+  const vector<int> &shorter = a.size() >= b.size() ? b : a;
+  if (BitParallelLcs::mask_words(shorter) <= MAX_MASK_WORDS) {
+    return BitParallelLcs(shorter).length(longer);
+  }
+  return lcs_wavefront(longer, shorter);
 }
 
-int main() {
+// Usage: lcs2 [--kernel bits|wavefront|rows] [--sequence [--threads N]]
+// With --sequence, also prints a longest common subsequence on a second line.
+// --kernel picks the way the length is computed instead of lcs2's choice.
+int main(int argc, char **argv) {
+  bool sequence = false;
+  std::string kernel;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--sequence") {
+      sequence = true;
+    } else if (arg == "--kernel" && i + 1 < argc) {
+      kernel = argv[++i];
+    } else if (arg == "--threads" && i + 1 < argc) {
+      threads = std::max(1, atoi(argv[++i]));
+    } else {
+      std::cerr << "Usage: lcs2 [--kernel bits|wavefront|rows] [--sequence [--threads N]]"
+                << std::endl;
+      return 1;
+    }
+  }
+
   size_t n;
   std::cin >> n;
   vector<int> a(n);
@@ -23,5 +260,27 @@ int main() {
     std::cin >> b[i];
   }
 
-  std::cout << lcs2(a, b) << std::endl;
+  if (!sequence) {
+    int length;
+    if (kernel == "bits") {
+      length = BitParallelLcs(b).length(a);
+    } else if (kernel == "wavefront") {
+      length = lcs_wavefront(a, b);
+    } else if (kernel == "rows") {
+      vector<int> len;
+      lcs_row(a.data(), 1, a.size(), b.data(), 1, b.size(), len);
+      length = len.back();
+    } else {
+      length = lcs2(a, b);
+    }
+    std::cout << length << std::endl;
+    return 0;
+  }
+
+  vector<int> common = LcsAligner(a, b).common_subsequence(threads);
+  std::cout << common.size() << '\n';
+  for (size_t i = 0; i < common.size(); ++i) {
+    std::cout << common[i] << ' ';
+  }
+  std::cout << std::endl;
 }
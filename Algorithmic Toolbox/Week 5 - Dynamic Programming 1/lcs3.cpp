@@ -1,14 +1,133 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
+#include <string>
+#include <thread>
 #include <vector>
 
 using std::vector;
 
-int lcs3(vector<int> &a, vector<int> &b, vector<int> &c) {
-  //write your code here
-  return std::min(std::min(a.size(), b.size()), c.size());
+// LCS of three sequences over the cube of prefix lengths (i, j, k), one
+// plane of fixed i at a time: a cell needs the one before it in j and in k
+// on its own plane and two cells of the previous plane, so the previous and
+// current planes are the whole memory.
+//
+// A plane is cut into bands of rows of b, one per thread, and each band
+// walks the columns of c in tiles. A tile starts once the band above has
+// finished the same tile of this plane, and the band below has finished the
+// next tile of the previous plane, whose buffer this plane overwrites. The
+// bands thus run as a pipeline across tiles and planes without a barrier.
+class Lcs3 {
+public:
+  Lcs3(const vector<int> &a, const vector<int> &b, const vector<int> &c)
+      : a_(a), b_(b), c_(c), cols_(c.size() + 1) {}
+
+  int length(int threads) {
+    size_t cells = (b_.size() + 1) * cols_;
+    planes_[0].assign(cells, 0);
+    planes_[1].assign(cells, 0);
+    tiles_ = (c_.size() + TILE - 1) / TILE;
+
+    int bands = b_.size() * c_.size() >= PARALLEL_CELLS ? threads : 1;
+    bands = std::max(1, std::min<int>(bands, b_.size()));
+    done_ = vector<std::atomic<long> >(bands);
+    for (int band = 0; band < bands; ++band) {
+      done_[band] = 0;
+    }
+
+    vector<std::thread> workers;
+    for (int band = 1; band < bands; ++band) {
+      workers.push_back(std::thread(&Lcs3::run_band, this, band, bands));
+    }
+    run_band(0, bands);
+    for (size_t t = 0; t < workers.size(); ++t) {
+      workers[t].join();
+    }
+
+    return planes_[a_.size() % 2][b_.size() * cols_ + c_.size()];
+  }
+
+private:
+  static const size_t TILE = 256;
+  static const size_t PARALLEL_CELLS = size_t(1) << 16;
+
+  const vector<int> &a_;
+  const vector<int> &b_;
+  const vector<int> &c_;
+  size_t cols_;
+  size_t tiles_;
+  vector<int> planes_[2];
+
+  // Tiles finished by each band, counted over all planes
+  vector<std::atomic<long> > done_;
+
+  void wait_for(int band, long tiles) const {
+    while (done_[band].load(std::memory_order_acquire) < tiles) {
+      std::this_thread::yield();
+    }
+  }
+
+  void run_band(int band, int bands) {
+    size_t first = 1 + b_.size() * band / bands;
+    size_t last = b_.size() * (band + 1) / bands;
+
+    for (size_t i = 1; i <= a_.size(); ++i) {
+      const int *prev = planes_[(i - 1) % 2].data();
+      int *cur = planes_[i % 2].data();
+      long plane = long(i - 1) * tiles_;
+
+      for (size_t tile = 0; tile < tiles_; ++tile) {
+        if (band > 0) {
+          wait_for(band - 1, plane + tile + 1);
+        }
+        if (band + 1 < bands && i > 1) {
+          wait_for(band + 1, plane - long(tiles_) + long(std::min(tile + 2, tiles_)));
+        }
+
+        size_t k0 = 1 + tile * TILE;
+        size_t k1 = std::min(c_.size(), (tile + 1) * TILE);
+        int x = a_[i - 1];
+        for (size_t j = first; j <= last; ++j) {
+          int *row = cur + j * cols_;
+          const int *up = cur + (j - 1) * cols_;
+          const int *back = prev + j * cols_;
+          const int *diagonal = prev + (j - 1) * cols_;
+          bool row_matches = x == b_[j - 1];
+          for (size_t k = k0; k <= k1; ++k) {
+            row[k] = row_matches && x == c_[k - 1]
+                         ? diagonal[k - 1] + 1
+                         : std::max(std::max(back[k], up[k]), row[k - 1]);
+          }
+        }
+
+        done_[band].store(plane + tile + 1, std::memory_order_release);
+      }
+    }
+  }
+};
+
+const size_t Lcs3::TILE;
+const size_t Lcs3::PARALLEL_CELLS;
+
+int lcs3(vector<int> &a, vector<int> &b, vector<int> &c,
+         int threads = std::max(1u, std::thread::hardware_concurrency())) {
+  if (a.empty() || b.empty() || c.empty()) {
+    return 0;
+  }
+  return Lcs3(a, b, c).length(threads);
 }
 
-int main() {
+// Usage: lcs3 [--threads N]
+int main(int argc, char **argv) {
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  if (argc == 3 && std::string(argv[1]) == "--threads") {
+    threads = std::max(1, atoi(argv[2]));
+  } else if (argc != 1) {
+    std::cerr << "Usage: lcs3 [--threads N]" << std::endl;
+    return 1;
+  }
+
   size_t an;
   std::cin >> an;
   vector<int> a(an);
@@ -27,5 +146,5 @@ int main() {
   for (size_t i = 0; i < cn; i++) {
     std::cin >> c[i];
   }
-  std::cout << lcs3(a, b, c) << std::endl;
+  std::cout << lcs3(a, b, c, threads) << std::endl;
 }
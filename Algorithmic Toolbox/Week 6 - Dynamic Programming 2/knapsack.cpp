@@ -10,42 +10,288 @@
  *  Date:   March 15, 2018
  **/
 
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 using std::vector;
 
 
+/**
+ *  Function optimal_value
+ *
+ *  The general 0/1 knapsack: the maximum total value of items whose weights
+ *  fit in W. best[w] is the best value within weight w over the items seen
+ *  so far, and walking w downwards lets one array stand for the previous
+ *  row, so the memory is O(W).
+ **/
+int optimal_value(int W, const vector<int> &weights, const vector<int> &values) {
+  vector<int> best(W + 1, 0);
+  for (size_t i = 0; i < weights.size(); ++i) {
+    for (int w = W; w >= weights[i]; --w) {
+      best[w] = std::max(best[w], best[w - weights[i]] + values[i]);
+    }
+  }
+  return best[W];
+}
+
+
+/**
+ *  Class SubsetSums
+ *
+ *  The sums of subsets of the bars seen so far that fit in the capacity, as
+ *  one bit per weight. Adding a bar of weight w ORs the set with itself
+ *  shifted by w, 64 weights per word operation, and only the words up to
+ *  the largest sum reached so far are touched.
+ **/
+class SubsetSums {
+public:
+  explicit SubsetSums(int capacity)
+      : capacity_(capacity), top_(0), bits_(capacity / 64 + 1, 0) {
+    bits_[0] = 1;
+  }
+
+  void add(int weight) {
+    if (weight <= 0 || weight > capacity_) {
+      return;
+    }
+    top_ = std::min(capacity_, top_ + weight);
+    size_t shift = weight / 64, offset = weight % 64;
+    // downwards, so every word reads words not yet updated
+    for (size_t i = top_ / 64 + 1; i-- > shift; ) {
+      bits_[i] |= shifted(bits_.data(), i - shift, offset);
+    }
+    clear_above_capacity();
+  }
+
+  bool reachable(int sum) const {
+    return (bits_[sum / 64] >> (sum % 64)) & 1;
+  }
+
+  // The largest reachable sum
+  int best() const {
+    for (size_t i = top_ / 64 + 1; i-- > 0; ) {
+      if (bits_[i] != 0) {
+        return 64 * i + 63 - __builtin_clzll(bits_[i]);
+      }
+    }
+    return 0;
+  }
+
+  // Word i of the set shifted up by 64 * (i - source) + offset
+  static uint64_t shifted(const uint64_t *bits, size_t source, size_t offset) {
+    uint64_t word = bits[source] << offset;
+    if (offset != 0 && source > 0) {
+      word |= bits[source - 1] >> (64 - offset);
+    }
+    return word;
+  }
+
+private:
+  int capacity_;
+  int top_;
+  vector<uint64_t> bits_;
+
+  void clear_above_capacity() {
+    if (capacity_ % 64 != 63) {
+      bits_.back() &= (uint64_t(2) << (capacity_ % 64)) - 1;
+    }
+  }
+
+  friend class ParallelSubsetSums;
+};
+
+
+/**
+ *  Class ParallelSubsetSums
+ *
+ *  SubsetSums for large capacities: every bar is added by all the threads,
+ *  each writing its own block of words of a second buffer from the first,
+ *  and the buffers swap at a barrier before the next bar.
+ **/
+class ParallelSubsetSums {
+public:
+  ParallelSubsetSums(int capacity, int threads)
+      : sums_(capacity), other_(sums_.bits_.size(), 0), threads_(threads), waiting_(0),
+        generation_(0) {}
+
+  int best_after(const vector<int> &weights) {
+    vector<std::thread> workers;
+    for (int t = 1; t < threads_; ++t) {
+      workers.push_back(std::thread(&ParallelSubsetSums::run, this, t, std::cref(weights)));
+    }
+    run(0, weights);
+    for (size_t t = 0; t < workers.size(); ++t) {
+      workers[t].join();
+    }
+    return sums_.best();
+  }
+
+private:
+  SubsetSums sums_;
+  vector<uint64_t> other_;
+  int threads_;
+
+  std::mutex mutex_;
+  std::condition_variable released_;
+  int waiting_;
+  long generation_;
+
+  // Blocks until every thread arrives; the last one to arrive runs last_step
+  template <typename F>
+  void barrier(F last_step) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    long generation = generation_;
+    if (++waiting_ == threads_) {
+      last_step();
+      waiting_ = 0;
+      ++generation_;
+      released_.notify_all();
+    } else {
+      released_.wait(lock, [&] { return generation_ != generation; });
+    }
+  }
+
+  void run(int thread, const vector<int> &weights) {
+    for (size_t i = 0; i < weights.size(); ++i) {
+      int weight = weights[i];
+      if (weight <= 0 || weight > sums_.capacity_) {
+        continue;
+      }
+      int top = std::min(sums_.capacity_, sums_.top_ + weight);
+      size_t words = top / 64 + 1;
+      size_t lo = words * thread / threads_, hi = words * (thread + 1) / threads_;
+      size_t shift = weight / 64, offset = weight % 64;
+      const uint64_t *from = sums_.bits_.data();
+      for (size_t w = lo; w < hi; ++w) {
+        other_[w] = from[w] | (w >= shift ? SubsetSums::shifted(from, w - shift, offset) : 0);
+      }
+      barrier([&] {
+        sums_.bits_.swap(other_);
+        sums_.top_ = top;
+        sums_.clear_above_capacity();
+      });
+    }
+  }
+};
+
+
 /**
  *  Function optimal_weight
  *
  *  Finds the maximum weight that can be carried given the maximum weight
  *  the knapsack can handle and the weights of the available bars of gold.
+ *  Capacities of at least PARALLEL_CAPACITY are split across threads.
  **/
-int optimal_weight(int W, const vector<int> &weights) {
-  int n = weights.size();
-  vector<vector<int>> current_weight(W + 1, vector<int>(n + 1, 0));
-  for (size_t i = 1; i <= n; ++i) {
-      for (size_t w = 1; w <= W; ++w) {
-          current_weight[w][i] = current_weight[w][i - 1];
-          int item_weight = weights[i - 1];
-          if (item_weight <= w) {
-              int num = current_weight[w - item_weight][i - 1] + item_weight;
-              if (current_weight[w][i] < num) {
-                  current_weight[w][i] = num;
-              }
-          }
+const int PARALLEL_CAPACITY = 1 << 22;
+
+int optimal_weight(int W, const vector<int> &weights, int threads = 1) {
+  if (threads > 1 && W >= PARALLEL_CAPACITY) {
+    return ParallelSubsetSums(W, threads).best_after(weights);
+  }
+  SubsetSums sums(W);
+  for (size_t i = 0; i < weights.size(); ++i) {
+    sums.add(weights[i]);
+  }
+  return sums.best();
+}
+
+
+/**
+ *  Function chosen_bars
+ *
+ *  The indices of a set of bars reaching optimal_weight. The sets of sums
+ *  are kept only before every k-th bar, k about sqrt(n), and the traceback
+ *  rebuilds the sets of one stretch of k bars at a time from its checkpoint,
+ *  so it holds about 2 sqrt(n) sets instead of n for twice the additions.
+ **/
+vector<int> chosen_bars(int W, const vector<int> &weights) {
+  size_t n = weights.size();
+  size_t stride = std::max<size_t>(1, std::sqrt(double(n)));
+  vector<SubsetSums> checkpoints;
+  SubsetSums sums(W);
+  for (size_t i = 0; i < n; ++i) {
+    if (i % stride == 0) {
+      checkpoints.push_back(sums);
+    }
+    sums.add(weights[i]);
+  }
+
+  vector<int> chosen;
+  int target = sums.best();
+  for (size_t c = checkpoints.size(); c-- > 0; ) {
+    size_t first = c * stride, last = std::min(n, first + stride);
+    // stretch[i - first] is the set before bar i
+    vector<SubsetSums> stretch(1, checkpoints[c]);
+    for (size_t i = first; i + 1 < last; ++i) {
+      stretch.push_back(stretch.back());
+      stretch.back().add(weights[i]);
+    }
+    for (size_t i = last; i-- > first; ) {
+      if (!stretch[i - first].reachable(target)) {
+        chosen.push_back(i);
+        target -= weights[i];
       }
+    }
   }
-  return current_weight[W][n];
+  std::reverse(chosen.begin(), chosen.end());
+  return chosen;
 }
 
-int main() {
+/**
+ *  Usage: knapsack [--rolling | --items] [--threads N]
+ *
+ *  --rolling computes the answer with the rolling value DP, and --items
+ *  also prints the indices of the bars carried on a second line.
+ **/
+int main(int argc, char **argv) {
+  bool rolling = false, items = false;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--rolling") {
+      rolling = true;
+    } else if (arg == "--items") {
+      items = true;
+    } else if (arg == "--threads" && i + 1 < argc) {
+      threads = std::max(1, atoi(argv[++i]));
+    } else {
+      std::cerr << "Usage: knapsack [--rolling | --items] [--threads N]" << std::endl;
+      return 1;
+    }
+  }
+
   int n, W;
   std::cin >> W >> n;
   vector<int> w(n);
   for (int i = 0; i < n; i++) {
     std::cin >> w[i];
   }
-  std::cout << optimal_weight(W, w) << '\n';
+
+  if (rolling) {
+    std::cout << optimal_value(W, w, w) << '\n';
+    return 0;
+  }
+  if (!items) {
+    std::cout << optimal_weight(W, w, threads) << '\n';
+    return 0;
+  }
+
+  vector<int> chosen = chosen_bars(W, w);
+  int total = 0;
+  for (size_t i = 0; i < chosen.size(); ++i) {
+    total += w[chosen[i]];
+  }
+  std::cout << total << '\n';
+  for (size_t i = 0; i < chosen.size(); ++i) {
+    std::cout << chosen[i] << ' ';
+  }
+  std::cout << '\n';
 }
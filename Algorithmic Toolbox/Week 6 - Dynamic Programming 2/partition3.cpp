@@ -1,19 +1,312 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
 #include <iostream>
+#include <string>
+#include <thread>
 #include <vector>
 
 using std::vector;
 
-int partition3(vector<int> &A) {
-  //write your code here
-  return 0;
+// Whether items can be split into three subsets of equal sum. Each item goes
+// to subset A, B or C, and with the sums of A and B both at target = sum / 3
+// the sum of C is too, so the search is over the pairs (a, b) of sums of A and
+// B, each at most target. Three ways are available:
+//
+//  - dynamic programming over the pairs as (target + 1) bit sets of target + 1
+//    bits, reach[a] holding the b reachable with a, where an item x ORs every
+//    set with itself shifted by x and with reach[a - x];
+//  - meet in the middle: the pairs reachable by the first half of the items,
+//    sorted, against those of the second half, which must complete a pair to
+//    (target, target), about 3^(n / 2) pairs on each side;
+//  - a depth-first search of all the assignments, which needs no memory.
+//
+// The first two are priced in word operations and the cheapest whose memory
+// fits is used, so small sums go to the DP and few items with huge values to
+// the enumeration. The enumerations fix the largest item in A and send the
+// first item that leaves A to B, since the subsets are interchangeable, and
+// split their branches across threads.
+class Partition3 {
+public:
+  enum Method { AUTO, DP, MEET_IN_THE_MIDDLE, SEARCH };
+
+  Partition3(const vector<int> &items, int threads) : items_(items), threads_(threads) {
+    std::sort(items_.begin(), items_.end(), std::greater<int>());
+    total_ = 0;
+    for (size_t i = 0; i < items_.size(); ++i) {
+      total_ += items_[i];
+    }
+    target_ = total_ / 3;
+  }
+
+  bool solve(Method method = AUTO) {
+    if (total_ % 3 != 0 || (!items_.empty() && items_[0] > target_)) {
+      return false;
+    }
+    if (target_ == 0) {
+      return true;
+    }
+    if (method == AUTO) {
+      method = choose();
+    }
+    // a forced method falls back when its memory does not fit, and meet in
+    // the middle also when the pairs cannot be packed into one word
+    if (method == DP && dp_memory() > MEMORY_LIMIT) {
+      method = mitm_memory() <= MEMORY_LIMIT ? MEET_IN_THE_MIDDLE : SEARCH;
+    }
+    if (method == MEET_IN_THE_MIDDLE && (mitm_memory() > MEMORY_LIMIT || target_ > UINT32_MAX)) {
+      method = SEARCH;
+    }
+    switch (method) {
+    case DP:
+      return dynamic_programming();
+    case MEET_IN_THE_MIDDLE:
+      return meet_in_the_middle();
+    default:
+      return search();
+    }
+  }
+
+private:
+  static constexpr double MEMORY_LIMIT = double(1 << 30);
+
+  vector<int> items_;
+  int threads_;
+  long long total_;
+  long long target_;
+
+  // Bytes of the bit sets of the DP
+  double dp_memory() const {
+    double rows = double(target_) + 1;
+    return rows * (rows / 64 + 1) * 8;
+  }
+
+  // Pairs of sums enumerated on each side of the meet in the middle
+  double mitm_pairs() const {
+    return std::pow(3.0, std::ceil((double(items_.size()) - 1) / 2));
+  }
+
+  double mitm_memory() const {
+    return mitm_pairs() * sizeof(uint64_t);
+  }
+
+  Method choose() const {
+    double dp_cost = double(items_.size()) * dp_memory() / 4;
+    double pairs = mitm_pairs();
+    double mitm_cost = 2 * pairs * std::log2(pairs + 2) / threads_;
+
+    bool dp_fits = dp_memory() <= MEMORY_LIMIT;
+    bool mitm_fits = mitm_memory() <= MEMORY_LIMIT;
+    if (dp_fits && (!mitm_fits || dp_cost <= mitm_cost)) {
+      return DP;
+    }
+    return mitm_fits ? MEET_IN_THE_MIDDLE : SEARCH;
+  }
+
+  bool dynamic_programming() const {
+    size_t size = target_ + 1;
+    size_t words = size / 64 + 1;
+    vector<uint64_t> reach(size * words, 0);
+    reach[0] = 1;
+    long long reached = 0, placed = 0;
+
+    for (size_t i = 0; i < items_.size(); ++i) {
+      size_t x = items_[i];
+      reached = std::min(target_, reached + (long long)x);
+      placed += x;
+      // C holds at most target, so a pair with a + b < placed - target is
+      // a dead end; its words are left as they are
+      long long needed = placed - target_;
+      size_t top_word = reached / 64;
+      size_t shift = x / 64, offset = x % 64;
+      // downwards in a, so reach[a - x] is still the set before this item,
+      // and downwards in the words of a row, for the same reason
+      for (long long a = reached; a >= std::max(0LL, needed - target_); --a) {
+        uint64_t *row = &reach[a * words];
+        const uint64_t *from = a >= (long long)x ? &reach[(a - x) * words] : NULL;
+        size_t low_word = std::max(0LL, needed - a) / 64;
+        for (size_t w = top_word + 1; w-- > low_word; ) {
+          uint64_t word = row[w];
+          if (w >= shift) {
+            word |= row[w - shift] << offset;
+            if (offset != 0 && w > shift) {
+              word |= row[w - shift - 1] >> (64 - offset);
+            }
+          }
+          if (from != NULL) {
+            word |= from[w];
+          }
+          row[w] = word;
+        }
+      }
+    }
+
+    return (reach[target_ * words + target_ / 64] >> (target_ % 64)) & 1;
+  }
+
+  // A partial assignment: the next item to place, the sums of A, B and C,
+  // and whether B and C are both still empty in the whole assignment.
+  struct State {
+    size_t next;
+    long long a, b, c;
+    bool tied;
+  };
+
+  // The states after placing the next item of s, in A, B or C in turn,
+  // that keep the sums within target; returns how many.
+  int place(State s, State *options) const {
+    long long x = items_[s.next++];
+    int count = 0;
+    if (s.a + x <= target_) {
+      options[count] = s;
+      options[count++].a += x;
+    }
+    if (s.b + x <= target_) {
+      options[count] = s;
+      options[count].b += x;
+      options[count++].tied = false;
+    }
+    if (s.c + x <= target_ && !s.tied) {
+      options[count] = s;
+      options[count++].c += x;
+    }
+    return count;
+  }
+
+  // Calls visit(a, b) for every assignment of items [state.next, last) on
+  // top of state that keeps all three sums within target.
+  template <typename Visit>
+  bool enumerate(State state, size_t last, Visit &visit) const {
+    if (state.next == last) {
+      return visit(state.a, state.b);
+    }
+    State options[3];
+    int count = place(state, options);
+    for (int k = 0; k < count; ++k) {
+      if (enumerate(options[k], last, visit)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Expands the first items after start breadth-first until there are
+  // enough branches to share between the threads, and runs visit on every
+  // branch, thread t taking the branches t, t + threads, ...; stops all of
+  // them once a visit returns true.
+  template <typename Visit>
+  bool enumerate_parallel(State start, size_t last, Visit visit) const {
+    vector<State> branches(1, start);
+    size_t wanted = 8 * threads_;
+    while (!branches.empty() && branches.size() < wanted && branches[0].next < last) {
+      vector<State> next;
+      for (size_t i = 0; i < branches.size(); ++i) {
+        State options[3];
+        int count = place(branches[i], options);
+        next.insert(next.end(), options, options + count);
+      }
+      branches.swap(next);
+    }
+
+    std::atomic<bool> found(false);
+    auto work = [&](int thread) {
+      auto checked = [&](long long a, long long b) {
+        if (found.load(std::memory_order_relaxed)) {
+          return true;
+        }
+        if (visit(thread, a, b)) {
+          found = true;
+          return true;
+        }
+        return false;
+      };
+      for (size_t i = thread; i < branches.size() && !found; i += threads_) {
+        enumerate(branches[i], last, checked);
+      }
+    };
+
+    vector<std::thread> workers;
+    for (int t = 1; t < threads_; ++t) {
+      workers.push_back(std::thread(work, t));
+    }
+    work(0);
+    for (size_t t = 0; t < workers.size(); ++t) {
+      workers[t].join();
+    }
+    return found;
+  }
+
+  static uint64_t key(long long a, long long b) {
+    return (uint64_t(a) << 32) | uint64_t(b);
+  }
+
+  bool meet_in_the_middle() const {
+    size_t half = (items_.size() + 1) / 2;
+    State first = {1, items_[0], 0, 0, true};
+
+    vector<vector<uint64_t> > found(threads_);
+    enumerate_parallel(first, half, [&](int thread, long long a, long long b) {
+      found[thread].push_back(key(a, b));
+      return false;
+    });
+    vector<uint64_t> left;
+    for (int t = 0; t < threads_; ++t) {
+      left.insert(left.end(), found[t].begin(), found[t].end());
+      vector<uint64_t>().swap(found[t]);
+    }
+    std::sort(left.begin(), left.end());
+    left.erase(std::unique(left.begin(), left.end()), left.end());
+
+    // B and C of the second half complete those of the first, so they are
+    // no longer interchangeable
+    State second = {half, 0, 0, 0, false};
+    return enumerate_parallel(second, items_.size(), [&](int, long long a, long long b) {
+      return std::binary_search(left.begin(), left.end(), key(target_ - a, target_ - b));
+    });
+  }
+
+  bool search() const {
+    State first = {1, items_[0], 0, 0, true};
+    return enumerate_parallel(first, items_.size(), [&](int, long long a, long long b) {
+      return a == target_ && b == target_;
+    });
+  }
+};
+
+constexpr double Partition3::MEMORY_LIMIT;
+
+int partition3(vector<int> &A, int threads = std::max(1u, std::thread::hardware_concurrency())) {
+  return Partition3(A, threads).solve() ? 1 : 0;
 }
 
-int main() {
+// Usage: partition3 [--method dp|mitm|search] [--threads N]
+int main(int argc, char **argv) {
+  Partition3::Method method = Partition3::AUTO;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    std::string value = i + 1 < argc ? argv[i + 1] : "";
+    if (arg == "--method" && (value == "dp" || value == "mitm" || value == "search")) {
+      method = value == "dp" ? Partition3::DP
+             : value == "mitm" ? Partition3::MEET_IN_THE_MIDDLE : Partition3::SEARCH;
+      ++i;
+    } else if (arg == "--threads" && !value.empty()) {
+      threads = std::max(1, atoi(value.c_str()));
+      ++i;
+    } else {
+      std::cerr << "Usage: partition3 [--method dp|mitm|search] [--threads N]" << std::endl;
+      return 1;
+    }
+  }
+
   int n;
   std::cin >> n;
   vector<int> A(n);
   for (size_t i = 0; i < A.size(); ++i) {
     std::cin >> A[i];
   }
-  std::cout << partition3(A) << '\n';
+  std::cout << (Partition3(A, threads).solve(method) ? 1 : 0) << '\n';
 }
@@ -8,29 +8,99 @@
 #include <iostream>
 #include <vector>
 #include <queue>
+#include <algorithm>
 
 using std::vector;
 using std::queue;
+using std::pair;
+
+// Graph in compressed sparse row form: the edges leaving node v are
+// target[offset[v]] .. target[offset[v + 1] - 1], and weight holds
+// the cost of each edge at the same index as its target.
+struct CsrGraph {
+    vector<int> offset;
+    vector<int> target;
+    vector<int> weight;
+
+    int size() const {
+        return (int)offset.size() - 1;
+    }
+};
+
+// Collects the edges of a graph and packs them into a CsrGraph.
+// Parallel edges are merged into a single edge with the smallest cost.
+class CsrBuilder {
+    int n_;
+    vector<int> from_;
+    vector<int> to_;
+    vector<int> cost_;
+
+public:
+    explicit CsrBuilder(int n) : n_(n) {}
+
+    void add_edge(int u, int v, int c = 0) {
+        from_.push_back(u);
+        to_.push_back(v);
+        cost_.push_back(c);
+    }
+
+    CsrGraph build() const {
+        CsrGraph g;
+        g.offset.assign(n_ + 1, 0);
+        for (size_t i = 0; i < from_.size(); i++) {
+            g.offset[from_[i] + 1]++;
+        }
+        for (int v = 0; v < n_; v++) {
+            g.offset[v + 1] += g.offset[v];
+        }
+
+        // Counting sort by source, then order each row by (target, cost)
+        // so that the cheapest of the parallel edges comes first.
+        vector<pair<int, int> > row(from_.size());
+        vector<int> next(g.offset.begin(), g.offset.end() - 1);
+        for (size_t i = 0; i < from_.size(); i++) {
+            row[next[from_[i]]++] = std::make_pair(to_[i], cost_[i]);
+        }
+
+        g.target.reserve(row.size());
+        g.weight.reserve(row.size());
+        int begin = 0;
+        for (int v = 0; v < n_; v++) {
+            int end = g.offset[v + 1];
+            std::sort(row.begin() + begin, row.begin() + end);
+            g.offset[v] = g.target.size();
+            for (int i = begin; i < end; i++) {
+                if (i == begin || row[i].first != row[i - 1].first) {
+                    g.target.push_back(row[i].first);
+                    g.weight.push_back(row[i].second);
+                }
+            }
+            begin = end;
+        }
+        g.offset[n_] = g.target.size();
+        return g;
+    }
+};
 
 struct Graph {
-    vector<vector<int> > adjacency_list;
+    CsrGraph csr;
     
-    Graph(vector<vector<int> > &adj) : adjacency_list(adj) {}
+    Graph(const CsrGraph &g) : csr(g) {}
     
     vector<int> distances_from_source(int s) {
         // returns a vector of the distances from s for all nodes in graph.
         // The distance for unreachable nodes is given as -1.
-        vector<int> dist(adjacency_list.size(), -1);
+        vector<int> dist(csr.size(), -1);
         dist[s] = 0;
         queue<int> q;
         q.push(s);
         while (! q.empty()) {
             int u = q.front(); q.pop();
-            for (vector<int>::iterator v = adjacency_list[u].begin();
-                 v != adjacency_list[u].end(); v++) {
-                if (dist[*v] == -1) {  // not discovered
-                    q.push(*v);
-                    dist[*v] = dist[u] + 1;
+            for (int i = csr.offset[u]; i < csr.offset[u + 1]; i++) {
+                int v = csr.target[i];
+                if (dist[v] == -1) {  // not discovered
+                    q.push(v);
+                    dist[v] = dist[u] + 1;
                 }
             }
         }
@@ -38,22 +108,22 @@ struct Graph {
     }
 };
 
-int distance(vector<vector<int> > &adj, int s, int t) {
-    return Graph(adj).distances_from_source(s)[t];
+int distance(const CsrGraph &g, int s, int t) {
+    return Graph(g).distances_from_source(s)[t];
 }
 
 int main() {
     int n, m;
     std::cin >> n >> m;
-    vector<vector<int> > adj(n, vector<int>());
+    CsrBuilder builder(n);
     for (int i = 0; i < m; i++) {
         int x, y;
         std::cin >> x >> y;
-        adj[x - 1].push_back(y - 1);
-        adj[y - 1].push_back(x - 1);
+        builder.add_edge(x - 1, y - 1);
+        builder.add_edge(y - 1, x - 1);
     }
     int s, t;
     std::cin >> s >> t;
     s--; t--;
-    std::cout << distance(adj, s, t);
+    std::cout << distance(builder.build(), s, t);
 }
@@ -10,15 +10,84 @@
 #include <queue>
 #include <functional>
 #include <limits>
+#include <algorithm>
 
 using std::vector;
 using std::queue;
 using std::pair;
 using std::priority_queue;
 
-int distance(vector<vector<int> > &adj, vector<vector<int> > &cost, int s, int t) {
+// Graph in compressed sparse row form: the edges leaving node v are
+// target[offset[v]] .. target[offset[v + 1] - 1], and weight holds
+// the cost of each edge at the same index as its target.
+struct CsrGraph {
+    vector<int> offset;
+    vector<int> target;
+    vector<int> weight;
+
+    int size() const {
+        return (int)offset.size() - 1;
+    }
+};
+
+// Collects the edges of a graph and packs them into a CsrGraph.
+// Parallel edges are merged into a single edge with the smallest cost.
+class CsrBuilder {
+    int n_;
+    vector<int> from_;
+    vector<int> to_;
+    vector<int> cost_;
+
+public:
+    explicit CsrBuilder(int n) : n_(n) {}
+
+    void add_edge(int u, int v, int c = 0) {
+        from_.push_back(u);
+        to_.push_back(v);
+        cost_.push_back(c);
+    }
+
+    CsrGraph build() const {
+        CsrGraph g;
+        g.offset.assign(n_ + 1, 0);
+        for (size_t i = 0; i < from_.size(); i++) {
+            g.offset[from_[i] + 1]++;
+        }
+        for (int v = 0; v < n_; v++) {
+            g.offset[v + 1] += g.offset[v];
+        }
+
+        // Counting sort by source, then order each row by (target, cost)
+        // so that the cheapest of the parallel edges comes first.
+        vector<pair<int, int> > row(from_.size());
+        vector<int> next(g.offset.begin(), g.offset.end() - 1);
+        for (size_t i = 0; i < from_.size(); i++) {
+            row[next[from_[i]]++] = std::make_pair(to_[i], cost_[i]);
+        }
+
+        g.target.reserve(row.size());
+        g.weight.reserve(row.size());
+        int begin = 0;
+        for (int v = 0; v < n_; v++) {
+            int end = g.offset[v + 1];
+            std::sort(row.begin() + begin, row.begin() + end);
+            g.offset[v] = g.target.size();
+            for (int i = begin; i < end; i++) {
+                if (i == begin || row[i].first != row[i - 1].first) {
+                    g.target.push_back(row[i].first);
+                    g.weight.push_back(row[i].second);
+                }
+            }
+            begin = end;
+        }
+        g.offset[n_] = g.target.size();
+        return g;
+    }
+};
+
+int distance(const CsrGraph &g, int s, int t) {
     // Initialize all distances: use -1 int as infinity and set source to 0
-    vector<int> dist(adj.size(), -1);
+    vector<int> dist(g.size(), -1);
     dist[s] = 0;
     
     // Priority queue for vertices, which are pairs with dist being first
@@ -26,7 +95,7 @@ int distance(vector<vector<int> > &adj, vector<vector<int> > &cost, int s, int t
     pq.push(std::make_pair(0, s));
     
     // Track processed vertices to allow multiple entries in queue
-    vector<bool> processed(adj.size(), false);
+    vector<bool> processed(g.size(), false);
     
     while (!pq.empty()) {
         pair<int, int> u = pq.top();
@@ -38,9 +107,9 @@ int distance(vector<vector<int> > &adj, vector<vector<int> > &cost, int s, int t
         
         processed[u.second] = true;
         
-        for (int i = 0; i < adj[u.second].size(); i++) {
-            int v = adj[u.second][i];
-            int w = cost[u.second][i];
+        for (int i = g.offset[u.second]; i < g.offset[u.second + 1]; i++) {
+            int v = g.target[i];
+            int w = g.weight[i];
             
             // relax edge
             if (dist[v] > dist[u.second] + w || dist[v] == -1) {
@@ -56,17 +125,15 @@ int distance(vector<vector<int> > &adj, vector<vector<int> > &cost, int s, int t
 int main() {
     int n, m;
     std::cin >> n >> m;
-    vector<vector<int> > adj(n, vector<int>());
-    vector<vector<int> > cost(n, vector<int>());
+    CsrBuilder builder(n);
     for (int i = 0; i < m; i++) {
         int x, y, w;
         std::cin >> x >> y >> w;
-        adj[x - 1].push_back(y - 1);
-        cost[x - 1].push_back(w);
+        builder.add_edge(x - 1, y - 1, w);
     }
     int s, t;
     std::cin >> s >> t;
     s--; t--;
-    std::cout << distance(adj, cost, s, t);
+    std::cout << distance(builder.build(), s, t);
 }
 
@@ -10,6 +10,7 @@
 #include <vector>
 #include <queue>
 #include <functional>
+#include <algorithm>
 
 using std::vector;
 using std::queue;
@@ -18,8 +19,75 @@ using std::priority_queue;
 
 typedef pair<long long, int> Vertex;
 
-void shortest_paths( vector<vector<int> > &adj,
-                    vector<vector<int> > &cost,
+// Graph in compressed sparse row form: the edges leaving node v are
+// target[offset[v]] .. target[offset[v + 1] - 1], and weight holds
+// the cost of each edge at the same index as its target.
+struct CsrGraph {
+    vector<int> offset;
+    vector<int> target;
+    vector<int> weight;
+
+    int size() const {
+        return (int)offset.size() - 1;
+    }
+};
+
+// Collects the edges of a graph and packs them into a CsrGraph.
+// Parallel edges are merged into a single edge with the smallest cost.
+class CsrBuilder {
+    int n_;
+    vector<int> from_;
+    vector<int> to_;
+    vector<int> cost_;
+
+public:
+    explicit CsrBuilder(int n) : n_(n) {}
+
+    void add_edge(int u, int v, int c = 0) {
+        from_.push_back(u);
+        to_.push_back(v);
+        cost_.push_back(c);
+    }
+
+    CsrGraph build() const {
+        CsrGraph g;
+        g.offset.assign(n_ + 1, 0);
+        for (size_t i = 0; i < from_.size(); i++) {
+            g.offset[from_[i] + 1]++;
+        }
+        for (int v = 0; v < n_; v++) {
+            g.offset[v + 1] += g.offset[v];
+        }
+
+        // Counting sort by source, then order each row by (target, cost)
+        // so that the cheapest of the parallel edges comes first.
+        vector<pair<int, int> > row(from_.size());
+        vector<int> next(g.offset.begin(), g.offset.end() - 1);
+        for (size_t i = 0; i < from_.size(); i++) {
+            row[next[from_[i]]++] = std::make_pair(to_[i], cost_[i]);
+        }
+
+        g.target.reserve(row.size());
+        g.weight.reserve(row.size());
+        int begin = 0;
+        for (int v = 0; v < n_; v++) {
+            int end = g.offset[v + 1];
+            std::sort(row.begin() + begin, row.begin() + end);
+            g.offset[v] = g.target.size();
+            for (int i = begin; i < end; i++) {
+                if (i == begin || row[i].first != row[i - 1].first) {
+                    g.target.push_back(row[i].first);
+                    g.weight.push_back(row[i].second);
+                }
+            }
+            begin = end;
+        }
+        g.offset[n_] = g.target.size();
+        return g;
+    }
+};
+
+void shortest_paths( const CsrGraph &g,
                     int s,
                     vector<long long> &distance,
                     vector<int> &reachable,
@@ -33,7 +101,7 @@ void shortest_paths( vector<vector<int> > &adj,
         priority_queue<Vertex, vector<Vertex>, std::greater<Vertex> > pq;
         pq.push(std::make_pair(0, s));
         
-        vector<bool> processed(adj.size(), false);
+        vector<bool> processed(g.size(), false);
         
         while (!pq.empty()) {
             Vertex u = pq.top();
@@ -45,9 +113,9 @@ void shortest_paths( vector<vector<int> > &adj,
             
             processed[u.second] = true;
             
-            for (int i = 0; i < adj[u.second].size(); i++) {
-                int v = adj[u.second][i];
-                int w = cost[u.second][i];
+            for (int i = g.offset[u.second]; i < g.offset[u.second + 1]; i++) {
+                int v = g.target[i];
+                int w = g.weight[i];
                 reachable[v] = 1;
                 if (distance[v] > distance[u.second] + w) {
                     distance[v] = distance[u.second] + w;
@@ -61,19 +129,19 @@ void shortest_paths( vector<vector<int> > &adj,
     // Use bellman ford |V| - 1 times
     bool dist_updated = false;
     int counter = 1;
-    while (counter < adj.size()) {
+    while (counter < g.size()) {
         
         queue<int> q;
         q.push(s);
-        vector<bool> visited(adj.size(), false);
+        vector<bool> visited(g.size(), false);
         visited[s] = true;
         
         while (!q.empty()) {
             int u = q.front();
             q.pop();
-            for (int i = 0; i < adj[u].size(); i++) {
-                int v = adj[u][i];
-                int w = cost[u][i];
+            for (int i = g.offset[u]; i < g.offset[u + 1]; i++) {
+                int v = g.target[i];
+                int w = g.weight[i];
                 reachable[v] = 1;
                 if (distance[v] > distance[u] + w) {
                     distance[v] = distance[u] + w;
@@ -96,15 +164,15 @@ void shortest_paths( vector<vector<int> > &adj,
         // find updated vertices
         queue<int> q;
         q.push(s);
-        vector<bool> visited(adj.size(), false);
+        vector<bool> visited(g.size(), false);
         visited[s] = true;
         
         while (!q.empty()) {
             int u = q.front();
             q.pop();
-            for (int i = 0; i < adj[u].size(); i++) {
-                int v = adj[u][i];
-                int w = cost[u][i];
+            for (int i = g.offset[u]; i < g.offset[u + 1]; i++) {
+                int v = g.target[i];
+                int w = g.weight[i];
                 if (distance[v] > distance[u] + w) {
                     distance[v] = distance[u] + w;
                     shortest[v] = 0;
@@ -118,19 +186,20 @@ void shortest_paths( vector<vector<int> > &adj,
     }
     
     // BFS on previously found vertices
-    vector<bool> visited(adj.size(), false);
-    for (int i = 0; i < adj.size(); i++) {
+    vector<bool> visited(g.size(), false);
+    for (int i = 0; i < g.size(); i++) {
         if (!shortest[i] && !visited[i]) {
             queue<int> q;
             q.push(i);
             while (!q.empty()) {
                 int u = q.front();
                 q.pop();
-                for (vector<int>::iterator v = adj[u].begin(); v != adj[u].end(); v++) {
-                    shortest[*v] = 0;
-                    if (!visited[*v]) {
-                        q.push(*v);
-                        visited[*v] = true;
+                for (int e = g.offset[u]; e < g.offset[u + 1]; e++) {
+                    int v = g.target[e];
+                    shortest[v] = 0;
+                    if (!visited[v]) {
+                        q.push(v);
+                        visited[v] = true;
                     }
                 }
             }
@@ -141,14 +210,12 @@ void shortest_paths( vector<vector<int> > &adj,
 int main() {
     int n, m, s;
     std::cin >> n >> m;
-    vector<vector<int> > adj(n, vector<int>());
-    vector<vector<int> > cost(n, vector<int>());
+    CsrBuilder builder(n);
     bool has_negative_weights = false;
     for (int i = 0; i < m; i++) {
         int x, y, w;
         std::cin >> x >> y >> w;
-        adj[x - 1].push_back(y - 1);
-        cost[x - 1].push_back(w);
+        builder.add_edge(x - 1, y - 1, w);
         if (w < 0 ) {
             has_negative_weights = true;
         }
@@ -158,7 +225,7 @@ int main() {
     vector<long long> distance(n, std::numeric_limits<long long>::max());
     vector<int> reachable(n, 0);
     vector<int> shortest(n, 1);
-    shortest_paths(adj, cost, s, distance, reachable, shortest, has_negative_weights);
+    shortest_paths(builder.build(), s, distance, reachable, shortest, has_negative_weights);
     for (int i = 0; i < n; i++) {
         if (!reachable[i]) {
             std::cout << "*\n";
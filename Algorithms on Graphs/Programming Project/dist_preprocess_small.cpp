@@ -6,7 +6,14 @@
 #include <queue>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 class Graph
 {
@@ -25,58 +32,285 @@ class Graph
     std::vector<std::vector<std::pair<int, int>>> incoming_edges;
 
     static constexpr int INFINITY = std::numeric_limits<int>::max() / 2;
+    // Rank of the nodes which are not contracted yet
+    static constexpr int UNRANKED = -1;
+    // Witness searches stop after settling this many nodes
+    static constexpr int MAX_SETTLED = 500;
+    // Witness searches do not relax edges of nodes that are this many hops from the source
+    static constexpr int MAX_HOPS = 5;
     // Levels of nodes for node ordering
     std::vector<int> level;
     // Ranks of nodes - positions in the node ordering
     std::vector<int> rank;
+    // Number of already contracted neighbors of each node
+    std::vector<int> contracted_neighbors;
 
     // Distance to node v, bidistance[0][v] - from source in the forward search, bidistance[1][v] - from target
     // in the backward search.
     std::vector<std::vector<Distance>> bidistance;
 
-    // Wrapper around STL priority_queue
-    class StlHeap
+    // Indexed D-ary min-heap with decrease-key. Every vertex is in the heap at most
+    // once: position[v] is its index in heap, or -1 if it is not there.
+    template <int D = 4>
+    class IndexedHeap
     {
     public:
         using T = std::pair<Distance, Vertex>;
-        using Queue = std::priority_queue<T, std::vector<T>, std::greater<T>>;
 
-        StlHeap() {
-            queue.reset(new Queue());
+        void resize(int n) {
+            heap.clear();
+            position.assign(n, -1);
         }
 
         bool empty() const {
-            return queue->empty();
+            return heap.empty();
+        }
+
+        const T& top() const {
+            return heap[0];
         }
 
+        // Inserts v with distance d, or decreases the distance of v if d is smaller
         void update(Vertex v, Distance d) {
-            queue->push(std::make_pair(d,v));
+            int i = position[v];
+            if (i < 0) {
+                i = heap.size();
+                heap.push_back(std::make_pair(d, v));
+            } else if (heap[i].first <= d) {
+                return;
+            }
+            sift_up(i, std::make_pair(d, v));
         }
 
+        // Removes the remaining vertices in O(size)
         void clear() {
-            queue.reset(new Queue());
+            for (const T& entry : heap) {
+                position[entry.second] = -1;
+            }
+            heap.clear();
         }
 
         std::pair<Distance, Vertex> pop() {
-            pair<Distance, Vertex> top = queue->top();
-            queue->pop();
+            std::pair<Distance, Vertex> top = heap[0];
+            position[top.second] = -1;
+            T last = heap.back();
+            heap.pop_back();
+            if (!heap.empty()) {
+                sift_down(0, last);
+            }
             return top;
         }
 
     private:
-        std::unique_ptr<Queue> queue;
+        void place(int i, const T& entry) {
+            heap[i] = entry;
+            position[entry.second] = i;
+        }
+
+        void sift_up(int i, T entry) {
+            while (i > 0) {
+                int parent = (i - 1) / D;
+                if (!(entry < heap[parent])) {
+                    break;
+                }
+                place(i, heap[parent]);
+                i = parent;
+            }
+            place(i, entry);
+        }
+
+        void sift_down(int i, T entry) {
+            int size = heap.size();
+            while (D * i + 1 < size) {
+                int first = D * i + 1;
+                int last = std::min(first + D, size);
+                int best = first;
+                for (int c = first + 1; c < last; ++c) {
+                    if (heap[c] < heap[best]) {
+                        best = c;
+                    }
+                }
+                if (!(heap[best] < entry)) {
+                    break;
+                }
+                place(i, heap[best]);
+                i = best;
+            }
+            place(i, entry);
+        }
+
+        std::vector<T> heap;
+        std::vector<int> position;
     };
 
     // Priority queues for forward and backward searches
-    StlHeap diqueue[2];
+    IndexedHeap<> diqueue[2];
+
+    // Read-only view of a graph in compressed sparse row form: the edges of node v
+    // are targets[offsets[v]..offsets[v + 1]) with the corresponding weights.
+    struct CsrView {
+        const int32_t* offsets = nullptr;
+        const int32_t* targets = nullptr;
+        const int32_t* weights = nullptr;
+    };
+
+    struct CsrArrays {
+        std::vector<int32_t> offsets;
+        std::vector<int32_t> targets;
+        std::vector<int32_t> weights;
+    };
+
+    // Graphs used by the queries: upward[0] has the edges going from each node to higher
+    // ranked nodes, upward[1] has the edges coming into each node from higher ranked nodes.
+    // They point either into upward_arrays or into the mapped index file.
+    CsrView upward[2];
+    CsrArrays upward_arrays[2];
+
+    // The index file the query graphs are mapped from, if any
+    class MappedFile
+    {
+    public:
+        MappedFile() : data(nullptr), size(0) {}
+        ~MappedFile() {
+            unmap();
+        }
+
+        bool map(const char* path) {
+            unmap();
+            int fd = open(path, O_RDONLY);
+            if (fd < 0) {
+                return false;
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size == 0) {
+                close(fd);
+                return false;
+            }
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if (p == MAP_FAILED) {
+                return false;
+            }
+            data = static_cast<const char*>(p);
+            size = st.st_size;
+            return true;
+        }
+
+        void unmap() {
+            if (data) {
+                munmap(const_cast<char*>(data), size);
+                data = nullptr;
+                size = 0;
+            }
+        }
+
+        const char* data;
+        size_t size;
+    };
+    MappedFile index_file;
+
+    // Layout of the index file: the header is followed by the sections listed in it,
+    // each one starting at a multiple of 8 bytes.
+    //   rank[N], then for the upward and the downward graph offsets[N + 1], targets[M], weights[M],
+    //   then shortcuts as (from, to, cost, via) quadruples. All values are int32.
+    // The header also identifies the input graph by its number of edges and a hash of them,
+    // and holds a checksum of its own fields and one of all the bytes after it. Loading only
+    // checks the header, so that it does not read the whole file; verify_index() checks the rest.
+    static constexpr char INDEX_MAGIC[8] = {'C', 'H', 'I', 'N', 'D', 'E', 'X', '\0'};
+    static constexpr uint32_t INDEX_VERSION = 2;
+
+    struct IndexHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t n;
+        uint64_t edges[2];
+        uint64_t shortcuts;
+        uint64_t input_edges;
+        uint64_t input_hash;
+        uint64_t data_checksum;
+        // Checksum of the fields above
+        uint64_t header_checksum;
+    };
+
+    // Number and hash of the edges of the input graph, written to the index file
+    uint64_t input_edges = 0;
+    uint64_t input_hash = 0;
+    // Checksum of the sections of the loaded index file
+    uint64_t data_checksum = 0;
+
+    static constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+
 public:
-    Graph() {
-        read_stdin();
+    // An edge as given on the input, with nodes numbered from 1
+    struct InputEdge {
+        int from, to, cost;
+    };
+
+    // FNV-1a hash of bytes, continuing from hash
+    static uint64_t hash_bytes(uint64_t hash, const void* data, size_t bytes) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; ++i) {
+            hash = (hash ^ p[i]) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // FNV-1a hash of the number of nodes and the edges of an input graph
+    static uint64_t hash_input(int n, const std::vector<InputEdge>& edges) {
+        uint64_t hash = FNV_OFFSET;
+        auto mix = [&hash](int value) {
+            for (int byte = 0; byte < 4; ++byte) {
+                hash = (hash ^ ((uint32_t)value >> (8 * byte) & 0xff)) * 1099511628211ULL;
+            }
+        };
+        mix(n);
+        for (const InputEdge& edge : edges) {
+            mix(edge.from);
+            mix(edge.to);
+            mix(edge.cost);
+        }
+        return hash;
+    }
+
+    Graph(int n, const std::vector<InputEdge>& edges) {
+        build(n, edges);
         bidistance.resize(2, std::vector<int>(N, INFINITY));
+        diqueue[0].resize(N);
+        diqueue[1].resize(N);
+    }
+
+    // Creates a graph ready for queries from an index written by save_index().
+    // The caller must check loaded() before querying.
+    explicit Graph(const char* index_path) : N(0) {
+        if (load_index(index_path)) {
+            bidistance.resize(2, std::vector<int>(N, INFINITY));
+            diqueue[0].resize(N);
+            diqueue[1].resize(N);
+        }
+    }
+
+    bool loaded() const {
+        return index_file.data != nullptr;
     }
 
     int get_n() { return N;}
 
+    // Reads all of the loaded index file: true iff its sections match the checksum in the header
+    // and the queries cannot walk out of the query graphs.
+    bool verify_index() const {
+        IndexHeader header;
+        memcpy(&header, index_file.data, sizeof(header));
+        size_t offset = (sizeof(IndexHeader) + 7) / 8 * 8;
+        uint64_t checksum = hash_bytes(FNV_OFFSET, index_file.data + offset, index_file.size - offset);
+        return checksum == data_checksum && valid_graph(upward[0], N, header.edges[0])
+               && valid_graph(upward[1], N, header.edges[1]);
+    }
+
+    // True iff the graph was built, or its index was saved, from exactly these nodes and edges
+    bool built_from(int n, const std::vector<InputEdge>& edges) const {
+        return N == n && input_edges == edges.size() && input_hash == hash_input(n, edges);
+    }
+
     std::vector<std::pair<int, int>>& get_adjacent(int v, bool forward = true) {
         if (forward) {
             return outgoing_edges[v];
@@ -87,27 +321,151 @@ public:
 
     void preprocess() {
         distance.resize(N, INFINITY);
+        hops.resize(N, 0);
+        level.assign(N, 0);
+        rank.assign(N, UNRANKED);
+        contracted_neighbors.assign(N, 0);
+        visited.resize(N);
+        marked.resize(N);
+
         // Priority queue will store pairs of (importance, node) with the least important node in the head
-        std::priority_queue<std::pair<int, int>, std::vector<std::pair<int,int>>, std::greater<std::pair<int, int>>> queue;
+        std::priority_queue<std::pair<int, int>, std::vector<std::pair<int,int>>, std::greater<std::pair<int, int>>> importance_queue;
 
-        // Implement the rest of the algorithm yourself
+        std::vector<Shortcut> shortcuts;
+        int mylevel;
+        for (int v = 0; v < N; ++v) {
+            importance_queue.push(std::make_pair(do_shortcut(v, shortcuts, mylevel), v));
+        }
+
+        // Lazy update: recompute the importance of the head and contract it only if it is
+        // still the least important node, otherwise put it back with the new value.
+        int next_rank = 0;
+        while (!importance_queue.empty()) {
+            int v = importance_queue.top().second;
+            importance_queue.pop();
+            int importance = do_shortcut(v, shortcuts, mylevel);
+            if (!importance_queue.empty() && importance > importance_queue.top().first) {
+                importance_queue.push(std::make_pair(importance, v));
+                continue;
+            }
+            contract(v, shortcuts, next_rank++);
+        }
+
+        build_upward_graphs();
+        distance.clear();
+        hops.clear();
+    }
+
+    // Writes the node ordering, the query graphs and the shortcuts added by preprocess().
+    // The file is written next to path and renamed over it, so processes which have the
+    // old index mapped keep reading a complete file.
+    bool save_index(const char* path) const {
+        std::string temp_path = std::string(path) + ".tmp";
+        FILE* out = fopen(temp_path.c_str(), "wb");
+        if (!out) {
+            return false;
+        }
+
+        IndexHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+        header.version = INDEX_VERSION;
+        header.n = N;
+        for (int side = 0; side < 2; ++side) {
+            header.edges[side] = upward_arrays[side].targets.size();
+        }
+        header.shortcuts = added_shortcuts.size();
+        header.input_edges = input_edges;
+        header.input_hash = input_hash;
+
+        std::vector<int32_t> shortcut_data;
+        shortcut_data.reserve(4 * added_shortcuts.size());
+        for (const Shortcut& shortcut : added_shortcuts) {
+            shortcut_data.insert(shortcut_data.end(), {shortcut.from, shortcut.to, shortcut.cost, shortcut.via});
+        }
+
+        // The header goes in last, once the checksum of the sections is known
+        uint64_t checksum = FNV_OFFSET;
+        bool ok = fseek(out, (sizeof(IndexHeader) + 7) / 8 * 8, SEEK_SET) == 0;
+        ok = ok && write_section(out, rank.data(), N * sizeof(int32_t), checksum);
+        for (int side = 0; side < 2; ++side) {
+            const CsrArrays& arrays = upward_arrays[side];
+            ok = ok && write_section(out, arrays.offsets.data(), arrays.offsets.size() * sizeof(int32_t), checksum);
+            ok = ok && write_section(out, arrays.targets.data(), arrays.targets.size() * sizeof(int32_t), checksum);
+            ok = ok && write_section(out, arrays.weights.data(), arrays.weights.size() * sizeof(int32_t), checksum);
+        }
+        ok = ok && write_section(out, shortcut_data.data(), shortcut_data.size() * sizeof(int32_t), checksum);
+        header.data_checksum = checksum;
+        header.header_checksum = hash_bytes(FNV_OFFSET, &header, offsetof(IndexHeader, header_checksum));
+        ok = ok && fseek(out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, out) == 1;
+        ok = fclose(out) == 0 && ok;
+        if (!ok || rename(temp_path.c_str(), path) != 0) {
+            remove(temp_path.c_str());
+            return false;
+        }
+        return true;
     }
 
     // Returns distance from s to t in the graph
     int query(int u, int w) {
+        clear();
         update(u, 0, true);
         update(w, 0, false);
         s = u; 
         t = w;
-        // Implement the rest of the algorithm yourself
 
-        return -1;
+        // Both searches only go up in the node ordering, and each of them stops
+        // once its closest unprocessed node is not closer than the estimate.
+        while (!diqueue[0].empty() || !diqueue[1].empty()) {
+            for (int side = 0; side < 2; ++side) {
+                if (diqueue[side].empty()) {
+                    continue;
+                }
+                std::pair<Distance, Vertex> top = diqueue[side].pop();
+                Distance d = top.first;
+                Vertex v = top.second;
+                if (d >= estimate) {
+                    diqueue[side].clear();
+                    continue;
+                }
+                const CsrView& graph = upward[side];
+                for (int32_t i = graph.offsets[v]; i < graph.offsets[v + 1]; ++i) {
+                    update(graph.targets[i], d + graph.weights[i], side == 0);
+                }
+            }
+        }
+
+        return estimate == INFINITY ? -1 : estimate;
     }
 
 private:
     // Try to relax the node v using distance d either in the forward or in the backward search
     void update(int v, int d, bool forward) {
-        // Implement this method yourself
+        int side = forward ? 0 : 1;
+        if (bidistance[side][v] <= d) {
+            return;
+        }
+        bidistance[side][v] = d;
+        diqueue[side].update(v, d);
+        visited.add(v);
+        if (bidistance[1 - side][v] < INFINITY) {
+            estimate = std::min(estimate, d + bidistance[1 - side][v]);
+        }
+    }
+
+    // Reset the distances touched by the previous query
+    void clear() {
+        for (int v : visited.get()) {
+            bidistance[0][v] = bidistance[1][v] = INFINITY;
+        }
+        visited.clear();
+        diqueue[0].clear();
+        diqueue[1].clear();
+        estimate = INFINITY;
+    }
+
+    bool is_contracted(int v) const {
+        return rank[v] != UNRANKED;
     }
 
     class VertexSet
@@ -126,7 +484,7 @@ private:
         const std::vector<int>& get() const {
             return vertices;
         }
-        const bool has(int v) {
+        bool has(int v) const {
             return visited[v];
         }
         void clear() {
@@ -140,7 +498,14 @@ private:
         std::vector<int> visited;
         std::vector<int> vertices;
     };
+    // Nodes touched by the current witness search or query
     VertexSet visited;
+    // Neighbors covered by a shortcut, or touched while contracting a node
+    VertexSet marked;
+
+    // Distances and hop counts of the witness search
+    std::vector<Distance> distance;
+    std::vector<int> hops;
 
     // QEntry = (distance, vertex)
     typedef std::pair<int,int> QEntry;
@@ -150,15 +515,233 @@ private:
         int from;
         int to;
         int cost;
+        // The contracted node the shortcut bypasses
+        int via;
     };
+    // All the shortcuts in the order they were added, kept for the index file
+    std::vector<Shortcut> added_shortcuts;
+
+    // Runs Dijkstra from source avoiding the node being contracted and all contracted nodes.
+    // Stops when the closest node is farther than limit, or after MAX_SETTLED nodes.
+    void witness_search(int source, int contracting, int limit) {
+        for (int v : visited.get()) {
+            distance[v] = INFINITY;
+        }
+        visited.clear();
+        queue = std::priority_queue<QEntry, std::vector<QEntry>, std::greater<QEntry>>();
+
+        distance[source] = 0;
+        hops[source] = 0;
+        visited.add(source);
+        queue.push(std::make_pair(0, source));
+
+        int settled = 0;
+        while (!queue.empty()) {
+            QEntry top = queue.top();
+            queue.pop();
+            int u = top.second;
+            if (top.first > distance[u]) {  // redundant entry
+                continue;
+            }
+            if (top.first > limit || ++settled > MAX_SETTLED) {
+                break;
+            }
+            if (hops[u] >= MAX_HOPS) {
+                continue;
+            }
+            for (const std::pair<int, int>& edge : outgoing_edges[u]) {
+                int w = edge.first;
+                if (w == contracting || is_contracted(w)) {
+                    continue;
+                }
+                int d = top.first + edge.second;
+                if (d < distance[w]) {
+                    distance[w] = d;
+                    hops[w] = hops[u] + 1;
+                    visited.add(w);
+                    queue.push(std::make_pair(d, w));
+                }
+            }
+        }
+    }
 
     // Adds all the shortcuts for the case when node v is contracted, and returns the importance of node v
     // in this case
     int do_shortcut(int v, std::vector<Shortcut>& shortcuts, int& mylevel) {
-        // Implement this method yourself
+        shortcuts.clear();
+        marked.clear();
+
+        int in_degree = 0;
+        int out_degree = 0;
+        int max_outgoing = 0;
+        for (const std::pair<int, int>& edge : outgoing_edges[v]) {
+            if (!is_contracted(edge.first)) {
+                ++out_degree;
+                max_outgoing = std::max(max_outgoing, edge.second);
+            }
+        }
+
+        for (const std::pair<int, int>& in_edge : incoming_edges[v]) {
+            int u = in_edge.first;
+            if (is_contracted(u)) {
+                continue;
+            }
+            ++in_degree;
+            if (out_degree == 0) {
+                continue;
+            }
+            witness_search(u, v, in_edge.second + max_outgoing);
+            for (const std::pair<int, int>& out_edge : outgoing_edges[v]) {
+                int w = out_edge.first;
+                if (w == u || is_contracted(w)) {
+                    continue;
+                }
+                int cost = in_edge.second + out_edge.second;
+                if (distance[w] > cost) {
+                    shortcuts.push_back(Shortcut{u, w, cost, v});
+                    marked.add(u);
+                    marked.add(w);
+                }
+            }
+        }
+
+        mylevel = level[v];
+        int edge_difference = (int)shortcuts.size() - in_degree - out_degree;
+        int shortcut_cover = (int)marked.get().size();
 
         // Add neighbors and shortcut cover heuristics
-        return (shortcuts.size() - outgoing_edges[v].size() - incoming_edges[v].size()) + mylevel;
+        return edge_difference + contracted_neighbors[v] + shortcut_cover + mylevel;
+    }
+
+    // Assigns the next rank to v, adds its shortcuts and updates the neighbors' heuristics
+    void contract(int v, const std::vector<Shortcut>& shortcuts, int v_rank) {
+        rank[v] = v_rank;
+        for (const Shortcut& shortcut : shortcuts) {
+            add_directed_edge(shortcut.from, shortcut.to, shortcut.cost);
+            added_shortcuts.push_back(shortcut);
+        }
+
+        marked.clear();
+        for (const std::pair<int, int>& edge : outgoing_edges[v]) {
+            marked.add(edge.first);
+        }
+        for (const std::pair<int, int>& edge : incoming_edges[v]) {
+            marked.add(edge.first);
+        }
+        for (int w : marked.get()) {
+            if (!is_contracted(w)) {
+                ++contracted_neighbors[w];
+                level[w] = std::max(level[w], level[v] + 1);
+            }
+        }
+    }
+
+    // After the ordering is fixed the queries only need edges going up in it:
+    // outgoing_edges for the forward search, incoming_edges for the backward one.
+    // They are packed into upward_arrays and the adjacency lists are released.
+    void build_upward_graphs() {
+        for (int side = 0; side < 2; ++side) {
+            std::vector<std::vector<std::pair<int, int>>>& lists = side == 0 ? outgoing_edges : incoming_edges;
+            CsrArrays& arrays = upward_arrays[side];
+            arrays.offsets.assign(1, 0);
+            arrays.offsets.reserve(N + 1);
+            for (int v = 0; v < N; ++v) {
+                for (const std::pair<int, int>& edge : lists[v]) {
+                    if (rank[edge.first] > rank[v]) {
+                        arrays.targets.push_back(edge.first);
+                        arrays.weights.push_back(edge.second);
+                    }
+                }
+                arrays.offsets.push_back(arrays.targets.size());
+            }
+            std::vector<std::vector<std::pair<int, int>>>().swap(lists);
+
+            upward[side].offsets = arrays.offsets.data();
+            upward[side].targets = arrays.targets.data();
+            upward[side].weights = arrays.weights.data();
+        }
+    }
+
+    // Writes a section padded to a multiple of 8 bytes and adds its bytes to checksum
+    static bool write_section(FILE* out, const void* data, size_t bytes, uint64_t& checksum) {
+        static const char padding[8] = {0};
+        if (bytes > 0 && fwrite(data, 1, bytes, out) != bytes) {
+            return false;
+        }
+        size_t pad = (8 - bytes % 8) % 8;
+        checksum = hash_bytes(hash_bytes(checksum, data, bytes), padding, pad);
+        return fwrite(padding, 1, pad, out) == pad;
+    }
+
+    // Returns the section of the mapped file starting at offset, or nullptr if the file is too short.
+    // Advances offset past the section and its padding.
+    const int32_t* map_section(size_t& offset, uint64_t count) const {
+        uint64_t bytes = count * sizeof(int32_t);
+        if (offset > index_file.size || bytes > index_file.size - offset) {
+            return nullptr;
+        }
+        const int32_t* section = reinterpret_cast<const int32_t*>(index_file.data + offset);
+        offset += (bytes + 7) / 8 * 8;
+        return section;
+    }
+
+    // True iff the queries can walk graph without leaving its arrays: the offsets go from 0
+    // to edges and never decrease, the targets are nodes and the weights are not negative.
+    // Reads all of the graph, so only verify_index() calls it.
+    static bool valid_graph(const CsrView& graph, uint32_t n, uint64_t edges) {
+        if (graph.offsets[0] != 0 || graph.offsets[n] != (int64_t)edges) {
+            return false;
+        }
+        for (uint32_t v = 0; v < n; ++v) {
+            if (graph.offsets[v + 1] < graph.offsets[v]) {
+                return false;
+            }
+        }
+        for (int32_t i = 0; i < graph.offsets[n]; ++i) {
+            if (graph.targets[i] < 0 || graph.targets[i] >= (int32_t)n || graph.weights[i] < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Maps the index file read-only and points the query graphs into it. Only the header is
+    // read, the sections are paged in by the queries. Rank and shortcuts are not needed by the
+    // queries and stay in the file.
+    bool load_index(const char* path) {
+        if (!index_file.map(path) || index_file.size < sizeof(IndexHeader)) {
+            index_file.unmap();
+            return false;
+        }
+        IndexHeader header;
+        memcpy(&header, index_file.data, sizeof(header));
+        if (memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) != 0 || header.version != INDEX_VERSION
+            || header.header_checksum != hash_bytes(FNV_OFFSET, &header, offsetof(IndexHeader, header_checksum))
+            || header.n > (uint32_t)std::numeric_limits<int32_t>::max()) {
+            index_file.unmap();
+            return false;
+        }
+
+        size_t offset = (sizeof(IndexHeader) + 7) / 8 * 8;
+        bool ok = map_section(offset, header.n) != nullptr;
+        for (int side = 0; ok && side < 2; ++side) {
+            upward[side].offsets = map_section(offset, header.n + 1ULL);
+            upward[side].targets = map_section(offset, header.edges[side]);
+            upward[side].weights = map_section(offset, header.edges[side]);
+            ok = upward[side].offsets && upward[side].targets && upward[side].weights;
+        }
+        ok = ok && map_section(offset, 4 * header.shortcuts) != nullptr && offset == index_file.size;
+        if (!ok) {
+            index_file.unmap();
+            return false;
+        }
+
+        N = header.n;
+        input_edges = header.input_edges;
+        input_hash = header.input_hash;
+        data_checksum = header.data_checksum;
+        visited.resize(N);
+        return true;
     }
 
     void set_n(int n) {
@@ -178,7 +761,7 @@ private:
                 return;
             }
         }
-        list.push_back(w, c);
+        list.push_back(std::make_pair(w, c));
     }
 
     void add_directed_edge(int u, int v, int c) {
@@ -192,31 +775,118 @@ private:
 
     void finalize() {
         // Remove unnecessary edges
+        for (int v = 0; v < N; ++v) {
+            for (std::vector<std::pair<int, int>>* list : {&outgoing_edges[v], &incoming_edges[v]}) {
+                list->erase(std::remove_if(list->begin(), list->end(),
+                                           [v](const std::pair<int, int>& edge) { return edge.first == v; }),
+                            list->end());
+            }
+        }
     }
 
-    bool read_stdin() {
-        int u,v,c,n,m;
-        assert(scanf("%d %d", &n, &m) == 2);
+    void build(int n, const std::vector<InputEdge>& edges) {
         set_n(n);
-        for (int i = 0; i < m; ++i) {
-            assert(scanf("%d %d %d", &u, &v, &c) == 3);
-            add_edge(u-1, v-1, c);
+        for (const InputEdge& edge : edges) {
+            add_edge(edge.from - 1, edge.to - 1, edge.cost);
         }
         finalize();
-        return true;
+        input_edges = edges.size();
+        input_hash = hash_input(n, edges);
     }
 };
 
-int main() {
-    Graph g;
-    g.preprocess();
+constexpr int Graph::INFINITY;
+constexpr int Graph::UNRANKED;
+constexpr char Graph::INDEX_MAGIC[8];
+
+// Reads the first line of the input into first and second and returns how many numbers it has:
+// two (the numbers of nodes and edges) if a graph follows, one (the number of queries) if not.
+static int read_first_line(int& first, int& second) {
+    char line[256];
+    if (!fgets(line, sizeof(line), stdin)) {
+        return 0;
+    }
+    return sscanf(line, "%d %d", &first, &second);
+}
+
+static std::vector<Graph::InputEdge> read_edges(int m) {
+    std::vector<Graph::InputEdge> edges(m);
+    for (Graph::InputEdge& edge : edges) {
+        assert(scanf("%d %d %d", &edge.from, &edge.to, &edge.cost) == 3);
+    }
+    return edges;
+}
+
+// Usage:
+//   dist_preprocess_small                        read the graph, preprocess it and answer queries
+//   dist_preprocess_small --save-index FILE      same, and also write the preprocessed graph to FILE
+//   dist_preprocess_small --index FILE           map the preprocessed graph from FILE and answer queries
+//   dist_preprocess_small --index FILE --verify  same, after reading all of FILE to check it is not corrupt
+//
+// With --index the input may hold only the queries. If it also holds the graph, the graph is
+// skipped when FILE is a valid index built from the same nodes and edges, and otherwise
+// preprocessed and written to FILE.
+
+int main(int argc, char** argv) {
+    const char* save_path = nullptr;
+    const char* index_path = nullptr;
+    bool verify = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else if (i + 1 == argc) {
+            break;
+        } else if (strcmp(argv[i], "--save-index") == 0) {
+            save_path = argv[++i];
+        } else if (strcmp(argv[i], "--index") == 0) {
+            index_path = argv[++i];
+        }
+    }
+
+    int n = 0, m = 0;
+    bool graph_follows = read_first_line(n, m) == 2;
+    std::vector<Graph::InputEdge> edges;
+    if (graph_follows) {
+        edges = read_edges(m);
+    }
+    std::unique_ptr<Graph> graph;
+    if (index_path) {
+        graph.reset(new Graph(index_path));
+        if (graph->loaded() && (!verify || graph->verify_index())
+            && (!graph_follows || graph->built_from(n, edges))) {
+            std::vector<Graph::InputEdge>().swap(edges);
+        } else if (graph_follows) {
+            fprintf(stderr, "Cannot load index %s, rebuilding it\n", index_path);
+            graph.reset();
+            save_path = index_path;
+        } else {
+            fprintf(stderr, "Cannot load index %s\n", index_path);
+            return 1;
+        }
+    } else if (!graph_follows) {
+        fprintf(stderr, "Expected the numbers of nodes and edges on the first line\n");
+        return 1;
+    }
+    if (!graph) {
+        graph.reset(new Graph(n, edges));
+        std::vector<Graph::InputEdge>().swap(edges);
+        graph->preprocess();
+        if (save_path && !graph->save_index(save_path)) {
+            fprintf(stderr, "Cannot write index %s\n", save_path);
+            return 1;
+        }
+    }
+    Graph& g = *graph;
     std::cout << "Ready" << std::endl;
 
-    int t;
-    assert(scanf("%d", &t) == 1);
+    // without a graph the first line held the number of queries
+    int t = n;
+    if (graph_follows) {
+        assert(scanf("%d", &t) == 1);
+    }
     for (int i = 0; i < t; ++i) {
         int u, v;
         assert(scanf("%d %d", &u, &v) == 2);
-        printf("%d\n", g.query(u-1, v-1, 3));
+        printf("%d\n", g.query(u-1, v-1));
     }
 }
@@ -1,64 +1,577 @@
 #include <cstdio>
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <vector>
 #include <queue>
 #include <limits>
 #include <utility>
 #include <cmath>
+#include <algorithm>
+#include <random>
 
 using namespace std;
 
 // See the explanations of these typedefs and constants in the starter for friend_suggestion
-typedef vector<vector<vector<int>>> Adj;
 typedef long long Len;
-typedef vector<priority_queue<pair<Len, int>,vector<pair<Len,int>>,greater<pair<Len,int>>>> Queue;
 
-const Len INFINITY = numeric_limits<Len>::max() / 4;
+// Named INF rather than INFINITY, which <cmath> defines as a macro
+const Len INF = numeric_limits<Len>::max() / 4;
+
+// Indexed D-ary min-heap of (key, node) pairs with decrease-key.
+// Every node is in the heap at most once: position_[v] is the index of v
+// in heap_, or -1 if v is not there. Memory is bounded by the number of nodes.
+template <typename Key, int D = 4>
+class IndexedHeap {
+    vector<pair<Key, int>> heap_;
+    vector<int> position_;
+
+public:
+    explicit IndexedHeap(int n = 0) : position_(n, -1) {}
+
+    bool empty() const { return heap_.empty(); }
+
+    const pair<Key, int>& top() const { return heap_[0]; }
+
+    // Inserts v with the given key, or decreases the key of v if it is smaller.
+    void update(int v, Key key) {
+        int i = position_[v];
+        if (i < 0) {
+            i = heap_.size();
+            heap_.push_back(make_pair(key, v));
+        } else if (!(key < heap_[i].first)) {
+            return;
+        }
+        sift_up(i, make_pair(key, v));
+    }
+
+    pair<Key, int> pop() {
+        pair<Key, int> top = heap_[0];
+        position_[top.second] = -1;
+        pair<Key, int> last = heap_.back();
+        heap_.pop_back();
+        if (!heap_.empty()) {
+            sift_down(0, last);
+        }
+        return top;
+    }
+
+    // Removes the remaining nodes in O(size).
+    void clear() {
+        for (size_t i = 0; i < heap_.size(); ++i) {
+            position_[heap_[i].second] = -1;
+        }
+        heap_.clear();
+    }
+
+private:
+    void place(int i, const pair<Key, int>& entry) {
+        heap_[i] = entry;
+        position_[entry.second] = i;
+    }
+
+    void sift_up(int i, pair<Key, int> entry) {
+        while (i > 0) {
+            int parent = (i - 1) / D;
+            if (!(entry < heap_[parent])) {
+                break;
+            }
+            place(i, heap_[parent]);
+            i = parent;
+        }
+        place(i, entry);
+    }
+
+    void sift_down(int i, pair<Key, int> entry) {
+        int size = heap_.size();
+        while (true) {
+            int first = D * i + 1;
+            if (first >= size) {
+                break;
+            }
+            int last = min(first + D, size);
+            int best = first;
+            for (int c = first + 1; c < last; ++c) {
+                if (heap_[c] < heap_[best]) {
+                    best = c;
+                }
+            }
+            if (!(heap_[best] < entry)) {
+                break;
+            }
+            place(i, heap_[best]);
+            i = best;
+        }
+        place(i, entry);
+    }
+};
+
+// Graph in compressed sparse row form: the edges leaving node v are
+// target[offset[v]] .. target[offset[v + 1] - 1], and weight holds
+// the cost of each edge at the same index as its target.
+struct CsrGraph {
+    vector<int> offset;
+    vector<int> target;
+    vector<int> weight;
+
+    int size() const {
+        return (int)offset.size() - 1;
+    }
+
+    // The same graph with every edge reversed.
+    CsrGraph reversed() const {
+        CsrGraph r;
+        r.offset.assign(size() + 1, 0);
+        for (size_t i = 0; i < target.size(); i++) {
+            r.offset[target[i] + 1]++;
+        }
+        for (int v = 0; v < size(); v++) {
+            r.offset[v + 1] += r.offset[v];
+        }
+        r.target.resize(target.size());
+        r.weight.resize(weight.size());
+        vector<int> next(r.offset.begin(), r.offset.end() - 1);
+        for (int u = 0; u < size(); u++) {
+            for (int i = offset[u]; i < offset[u + 1]; i++) {
+                int j = next[target[i]]++;
+                r.target[j] = u;
+                r.weight[j] = weight[i];
+            }
+        }
+        return r;
+    }
+};
+
+// Collects the edges of a graph and packs them into a CsrGraph.
+// Parallel edges are merged into a single edge with the smallest cost.
+class CsrBuilder {
+    int n_;
+    vector<int> from_;
+    vector<int> to_;
+    vector<int> cost_;
+
+public:
+    explicit CsrBuilder(int n) : n_(n) {}
+
+    void add_edge(int u, int v, int c = 0) {
+        from_.push_back(u);
+        to_.push_back(v);
+        cost_.push_back(c);
+    }
+
+    CsrGraph build() const {
+        CsrGraph g;
+        g.offset.assign(n_ + 1, 0);
+        for (size_t i = 0; i < from_.size(); i++) {
+            g.offset[from_[i] + 1]++;
+        }
+        for (int v = 0; v < n_; v++) {
+            g.offset[v + 1] += g.offset[v];
+        }
+
+        // Counting sort by source, then order each row by (target, cost)
+        // so that the cheapest of the parallel edges comes first.
+        vector<pair<int, int> > row(from_.size());
+        vector<int> next(g.offset.begin(), g.offset.end() - 1);
+        for (size_t i = 0; i < from_.size(); i++) {
+            row[next[from_[i]]++] = std::make_pair(to_[i], cost_[i]);
+        }
+
+        g.target.reserve(row.size());
+        g.weight.reserve(row.size());
+        int begin = 0;
+        for (int v = 0; v < n_; v++) {
+            int end = g.offset[v + 1];
+            std::sort(row.begin() + begin, row.begin() + end);
+            g.offset[v] = g.target.size();
+            for (int i = begin; i < end; i++) {
+                if (i == begin || row[i].first != row[i - 1].first) {
+                    g.target.push_back(row[i].first);
+                    g.weight.push_back(row[i].second);
+                }
+            }
+            begin = end;
+        }
+        g.offset[n_] = g.target.size();
+        return g;
+    }
+};
+
+// The queues are keyed by distance plus potential, which is not integer.
+typedef vector<IndexedHeap<double>> Queue;
+
+// Runs Dijkstra on g from all the sources at once and returns the distances,
+// INF for unreachable nodes. If order is given, it receives the nodes in the
+// order they were settled, and parent receives their shortest path tree.
+vector<Len> dijkstra(const CsrGraph& g, const vector<int>& sources,
+                     vector<int>* order = nullptr, vector<int>* parent = nullptr) {
+    vector<Len> dist(g.size(), INF);
+    IndexedHeap<Len> q(g.size());
+    if (parent) {
+        parent->assign(g.size(), -1);
+    }
+    for (int s : sources) {
+        dist[s] = 0;
+        q.update(s, 0);
+    }
+    while (!q.empty()) {
+        pair<Len, int> top = q.pop();
+        int u = top.second;
+        if (order) {
+            order->push_back(u);
+        }
+        for (int i = g.offset[u]; i < g.offset[u + 1]; ++i) {
+            int v = g.target[i];
+            if (dist[v] > top.first + g.weight[i]) {
+                dist[v] = top.first + g.weight[i];
+                q.update(v, dist[v]);
+                if (parent) {
+                    (*parent)[v] = u;
+                }
+            }
+        }
+    }
+    return dist;
+}
+
+// Landmarks for the ALT (A*, landmarks, triangle inequality) potential.
+// For every landmark L the distances d(L, v) and d(v, L) to all the nodes
+// are precomputed, and by the triangle inequality
+//     d(u, v) >= max(d(u, L) - d(v, L), d(L, v) - d(L, u)).
+// The tables are stored node by node so that a bound reads one row per node.
+class Landmarks {
+    int n_;
+    int k_;
+    vector<int> landmarks_;
+    // from_[v * k_ + i] = d(landmarks_[i], v), to_[v * k_ + i] = d(v, landmarks_[i])
+    vector<Len> from_;
+    vector<Len> to_;
+
+public:
+    enum Strategy { FARTHEST, AVOID };
+
+    Landmarks() : n_(0), k_(0) {}
+
+    // Selects up to k landmarks on graph with the given strategy and computes their tables.
+    //   FARTHEST: each landmark is the node farthest from the ones already chosen,
+    //             preferring nodes they cannot reach at all.
+    //   AVOID:    grows a shortest path tree from a random root and descends into the
+    //             subtree where the current landmarks give the worst bounds.
+    Landmarks(const CsrGraph& graph, int k, Strategy strategy) : n_(graph.size()), k_(0) {
+        CsrGraph reversed = graph.reversed();
+        mt19937 rng(2018);
+        k = min(k, n_);
+        while (k_ < k) {
+            int landmark = strategy == FARTHEST ? farthest(graph) : avoid(graph, rng);
+            if (landmark < 0) {
+                break;
+            }
+            add(landmark, graph, reversed);
+        }
+    }
+
+    int size() const { return k_; }
+
+    const vector<int>& nodes() const { return landmarks_; }
+
+    // Lower bound on the distance from u to v; 0 without landmarks.
+    Len lower_bound(int u, int v) const {
+        Len bound = 0;
+        if (k_ == 0) {
+            return bound;
+        }
+        const Len* from_u = &from_[(size_t)u * k_];
+        const Len* from_v = &from_[(size_t)v * k_];
+        const Len* to_u = &to_[(size_t)u * k_];
+        const Len* to_v = &to_[(size_t)v * k_];
+        for (int i = 0; i < k_; ++i) {
+            if (to_u[i] < INF && to_v[i] < INF) {
+                bound = max(bound, to_u[i] - to_v[i]);
+            }
+            if (from_u[i] < INF && from_v[i] < INF) {
+                bound = max(bound, from_v[i] - from_u[i]);
+            }
+        }
+        return bound;
+    }
+
+    // File layout: "ALTLMK1" and a zero byte, n and k as int32, the k landmark
+    // ids as int32, then the from and to tables as int64, n * k entries each.
+    bool save(const char* path) const {
+        FILE* out = fopen(path, "wb");
+        if (!out) {
+            return false;
+        }
+        int32_t header[2] = {n_, k_};
+        vector<int32_t> ids(landmarks_.begin(), landmarks_.end());
+        bool ok = fwrite(MAGIC, 1, sizeof(MAGIC), out) == sizeof(MAGIC)
+                  && fwrite(header, sizeof(int32_t), 2, out) == 2
+                  && fwrite(ids.data(), sizeof(int32_t), ids.size(), out) == ids.size()
+                  && fwrite(from_.data(), sizeof(Len), from_.size(), out) == from_.size()
+                  && fwrite(to_.data(), sizeof(Len), to_.size(), out) == to_.size();
+        return fclose(out) == 0 && ok;
+    }
+
+    // Reads tables written by save() for a graph with n nodes.
+    bool load(const char* path, int n) {
+        FILE* in = fopen(path, "rb");
+        if (!in) {
+            return false;
+        }
+        char magic[sizeof(MAGIC)];
+        int32_t header[2];
+        bool ok = fread(magic, 1, sizeof(magic), in) == sizeof(magic)
+                  && memcmp(magic, MAGIC, sizeof(magic)) == 0
+                  && fread(header, sizeof(int32_t), 2, in) == 2
+                  && header[0] == n && header[1] >= 0 && header[1] <= n;
+        if (ok) {
+            n_ = header[0];
+            k_ = header[1];
+            vector<int32_t> ids(k_);
+            from_.resize((size_t)n_ * k_);
+            to_.resize((size_t)n_ * k_);
+            ok = fread(ids.data(), sizeof(int32_t), ids.size(), in) == ids.size()
+                 && fread(from_.data(), sizeof(Len), from_.size(), in) == from_.size()
+                 && fread(to_.data(), sizeof(Len), to_.size(), in) == to_.size();
+            landmarks_.assign(ids.begin(), ids.end());
+        }
+        fclose(in);
+        if (!ok) {
+            *this = Landmarks();
+        }
+        return ok;
+    }
+
+private:
+    static constexpr char MAGIC[8] = {'A', 'L', 'T', 'L', 'M', 'K', '1', '\0'};
+
+    void add(int landmark, const CsrGraph& graph, const CsrGraph& reversed) {
+        vector<Len> from = dijkstra(graph, vector<int>(1, landmark));
+        vector<Len> to = dijkstra(reversed, vector<int>(1, landmark));
+        vector<Len> from_table((size_t)n_ * (k_ + 1));
+        vector<Len> to_table((size_t)n_ * (k_ + 1));
+        for (int v = 0; v < n_; ++v) {
+            copy(from_.begin() + (size_t)v * k_, from_.begin() + (size_t)(v + 1) * k_, from_table.begin() + (size_t)v * (k_ + 1));
+            copy(to_.begin() + (size_t)v * k_, to_.begin() + (size_t)(v + 1) * k_, to_table.begin() + (size_t)v * (k_ + 1));
+            from_table[(size_t)v * (k_ + 1) + k_] = from[v];
+            to_table[(size_t)v * (k_ + 1) + k_] = to[v];
+        }
+        from_.swap(from_table);
+        to_.swap(to_table);
+        landmarks_.push_back(landmark);
+        ++k_;
+    }
+
+    // Node farthest from the current landmarks, or -1 if all the nodes are landmarks
+    int farthest(const CsrGraph& graph) const {
+        if (landmarks_.empty()) {
+            vector<Len> dist = dijkstra(graph, vector<int>(1, 0));
+            return max_reachable(dist, -1);
+        }
+        vector<Len> dist = dijkstra(graph, landmarks_);
+        for (int v = 0; v < n_; ++v) {
+            if (dist[v] == INF) {
+                return v;
+            }
+        }
+        return max_reachable(dist, 0);
+    }
+
+    // Index of the largest finite distance greater than floor, or -1
+    static int max_reachable(const vector<Len>& dist, Len floor) {
+        int best = -1;
+        for (int v = 0; v < (int)dist.size(); ++v) {
+            if (dist[v] < INF && dist[v] > floor && (best < 0 || dist[v] > dist[best])) {
+                best = v;
+            }
+        }
+        return best;
+    }
+
+    // Goldberg and Werneck's avoid heuristic. The weight of a node in the shortest
+    // path tree of the root is the gap between its distance and the current lower
+    // bound. Subtrees that contain a landmark are ignored, and from the root we
+    // follow the child with the heaviest subtree down to a leaf.
+    int avoid(const CsrGraph& graph, mt19937& rng) const {
+        for (int attempt = 0; attempt < 8; ++attempt) {
+            int root = uniform_int_distribution<int>(0, n_ - 1)(rng);
+            vector<int> order;
+            vector<int> parent;
+            vector<Len> dist = dijkstra(graph, vector<int>(1, root), &order, &parent);
+
+            vector<Len> size(n_, 0);
+            vector<char> has_landmark(n_, false);
+            for (int landmark : landmarks_) {
+                has_landmark[landmark] = true;
+            }
+            for (int i = order.size() - 1; i >= 0; --i) {
+                int v = order[i];
+                if (has_landmark[v]) {
+                    size[v] = 0;
+                } else {
+                    size[v] += dist[v] - lower_bound(root, v);
+                }
+                if (parent[v] >= 0) {
+                    if (has_landmark[v]) {
+                        has_landmark[parent[v]] = true;
+                    }
+                    size[parent[v]] += size[v];
+                }
+            }
+            if (has_landmark[root] || size[root] == 0) {
+                continue;
+            }
+
+            vector<vector<int>> children(n_);
+            for (int v : order) {
+                if (parent[v] >= 0) {
+                    children[parent[v]].push_back(v);
+                }
+            }
+            int v = root;
+            while (true) {
+                int next = -1;
+                for (int c : children[v]) {
+                    if (!has_landmark[c] && size[c] > 0 && (next < 0 || size[c] > size[next])) {
+                        next = c;
+                    }
+                }
+                if (next < 0) {
+                    break;
+                }
+                v = next;
+            }
+            return v;
+        }
+        return farthest(graph);
+    }
+};
+
+constexpr char Landmarks::MAGIC[8];
 
 class AStar {
     // See the descriptions of these fields in the starter for friend_suggestion
     int n_;
-    Adj adj_;
-    Adj cost_;
+    CsrGraph graph_[2];
     vector<vector<Len>> distance_;
     vector<int> workset_;
     vector<bool> visited_;
     // Coordinates of the nodes
     std::vector<std::pair<Len,Len>> xy_;
+    Queue queue_;
+    Len best_;
+    // Source and target of the current query
+    int s_, t_;
+    // If set, the potentials come from these landmarks instead of the coordinates
+    const Landmarks* landmarks_;
 
 public:
-    AStar(int n, Adj adj, Adj cost, std::vector<std::pair<Len,Len>> xy)
-        : n_(n), adj_(adj), cost_(cost), distance_(2, vector<Len>(n_, INFINITY)), visited_(n), xy_(xy)
+    AStar(int n, const CsrGraph& graph, std::vector<std::pair<Len,Len>> xy)
+        : n_(n), graph_{graph, graph.reversed()}, distance_(2, vector<Len>(n_, INF)), visited_(n), xy_(xy),
+          queue_(2, IndexedHeap<double>(n)), best_(INF), s_(0), t_(0),
+          landmarks_(nullptr)
     { workset_.reserve(n); }
 
+    // Switches to the ALT potential, or back to the Euclidean one if landmarks is null.
+    // The landmarks must outlive the queries.
+    void use_landmarks(const Landmarks* landmarks) {
+        landmarks_ = landmarks;
+    }
+
     // See the description of this method in the starter for friend_suggestion
     void clear() {
         for (int i = 0; i < workset_.size(); ++i) {
             int v = workset_[i];
-            distance_[0][v] = distance_[1][v] = INFINITY;
+            distance_[0][v] = distance_[1][v] = INF;
             visited_[v] = false;
         }
         workset_.clear();
+        queue_[0].clear();
+        queue_[1].clear();
+        best_ = INF;
+    }
+
+    // Euclidean distance between nodes u and v
+    double euclidean(int u, int v) const {
+        double dx = xy_[u].first - xy_[v].first;
+        double dy = xy_[u].second - xy_[v].second;
+        return sqrt(dx * dx + dy * dy);
+    }
+
+    // Average potential of the forward search: half of the way left to t
+    // minus half of the way from s. The backward search uses its negation,
+    // so both searches see the same reduced edge costs.
+    double potential(int v) const {
+        if (landmarks_) {
+            return (landmarks_->lower_bound(v, t_) - landmarks_->lower_bound(s_, v)) / 2.0;
+        }
+        return (euclidean(v, t_) - euclidean(s_, v)) / 2;
     }
 
     // See the description of this method in the starter for friend_suggestion
     void visit(Queue& q, int side, int v, Len dist) {
-        // Implement this method yourself
+        if (distance_[side][v] <= dist) {
+            return;
+        }
+        distance_[side][v] = dist;
+        q[side].update(v, dist + (side == 0 ? potential(v) : -potential(v)));
+        if (!visited_[v]) {
+            visited_[v] = true;
+            workset_.push_back(v);
+        }
+        if (distance_[1 - side][v] < INF) {
+            best_ = min(best_, dist + distance_[1 - side][v]);
+        }
     }
 
     // Returns the distance from s to t in the graph
     Len query(int s, int t) {
         clear();
-        Queue q(2);
+        s_ = s;
+        t_ = t;
+        Queue& q = queue_;
         visit(q, 0, s, 0);
         visit(q, 1, t, 0);
-        // Implement the rest of the algorithm yourself
 
-        return -1;
+        // The potentials of a node cancel out in the sum of its forward and
+        // backward keys, so the stopping rule is the one of Bidijkstra.
+        while (!q[0].empty() && !q[1].empty() && q[0].top().first + q[1].top().first < best_) {
+            int side = q[0].top().first <= q[1].top().first ? 0 : 1;
+            int u = q[side].pop().second;
+            const CsrGraph& g = graph_[side];
+            for (int i = g.offset[u]; i < g.offset[u + 1]; ++i) {
+                visit(q, side, g.target[i], distance_[side][u] + g.weight[i]);
+            }
+        }
+
+        return best_ == INF ? -1 : best_;
     }
 };
 
-int main() {
+// Usage:
+//   dist_with_coords                          Euclidean potential
+//   dist_with_coords --landmarks K            ALT potential with K landmarks chosen by the farthest strategy
+//   dist_with_coords --landmarks K --avoid    the same with the avoid strategy
+//   dist_with_coords --save-landmarks FILE    also write the landmark tables to FILE
+//   dist_with_coords --load-landmarks FILE    ALT potential with the landmark tables read from FILE
+int main(int argc, char** argv) {
+    int landmark_count = 0;
+    Landmarks::Strategy strategy = Landmarks::FARTHEST;
+    const char* save_path = nullptr;
+    const char* load_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--avoid") == 0) {
+            strategy = Landmarks::AVOID;
+        } else if (i + 1 < argc && strcmp(argv[i], "--landmarks") == 0) {
+            landmark_count = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--save-landmarks") == 0) {
+            save_path = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--load-landmarks") == 0) {
+            load_path = argv[++i];
+        }
+    }
+
     int n, m;
     scanf("%d%d", &n, &m);
     std::vector<std::pair<Len,Len>> xy(n);
@@ -67,18 +580,32 @@ int main() {
         scanf("%d%d", &a, &b);
         xy[i] = make_pair(a,b);
     }
-    Adj adj(2, vector<vector<int>>(n));
-    Adj cost(2, vector<vector<int>>(n));
+    CsrBuilder builder(n);
     for (int i=0; i<m; ++i) {
         int u, v, c;
         scanf("%d%d%d", &u, &v, &c);
-        adj[0][u-1].push_back(v-1);
-        cost[0][u-1].push_back(c);
-        adj[1][v-1].push_back(u-1);
-        cost[1][v-1].push_back(c);
+        builder.add_edge(u-1, v-1, c);
     }
 
-    AStar astar(n, adj, cost, xy);
+    CsrGraph graph = builder.build();
+    AStar astar(n, graph, xy);
+
+    Landmarks landmarks;
+    if (load_path) {
+        if (!landmarks.load(load_path, n)) {
+            fprintf(stderr, "Cannot load landmarks %s\n", load_path);
+            return 1;
+        }
+    } else if (landmark_count > 0) {
+        landmarks = Landmarks(graph, landmark_count, strategy);
+    }
+    if (save_path && !landmarks.save(save_path)) {
+        fprintf(stderr, "Cannot write landmarks %s\n", save_path);
+        return 1;
+    }
+    if (landmarks.size() > 0) {
+        astar.use_landmarks(&landmarks);
+    }
 
     int t;
     scanf("%d", &t);
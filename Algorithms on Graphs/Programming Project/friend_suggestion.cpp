@@ -4,98 +4,354 @@
 #include <queue>
 #include <limits>
 #include <utility>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 using namespace std;
 
-// External vector of size 2 - for forward and backward search.
-// Internal 2-dimensional vector is vector of adjacency lists for each node.
-typedef vector<vector<vector<int>>> Adj;
+// Graph in compressed sparse row form: the edges leaving node v are
+// target[offset[v]] .. target[offset[v + 1] - 1], and weight holds
+// the cost of each edge at the same index as its target.
+struct CsrGraph {
+    vector<int> offset;
+    vector<int> target;
+    vector<int> weight;
+
+    int size() const {
+        return (int)offset.size() - 1;
+    }
+
+    // The same graph with every edge reversed.
+    CsrGraph reversed() const {
+        CsrGraph r;
+        r.offset.assign(size() + 1, 0);
+        for (size_t i = 0; i < target.size(); i++) {
+            r.offset[target[i] + 1]++;
+        }
+        for (int v = 0; v < size(); v++) {
+            r.offset[v + 1] += r.offset[v];
+        }
+        r.target.resize(target.size());
+        r.weight.resize(weight.size());
+        vector<int> next(r.offset.begin(), r.offset.end() - 1);
+        for (int u = 0; u < size(); u++) {
+            for (int i = offset[u]; i < offset[u + 1]; i++) {
+                int j = next[target[i]]++;
+                r.target[j] = u;
+                r.weight[j] = weight[i];
+            }
+        }
+        return r;
+    }
+};
+
+// Collects the edges of a graph and packs them into a CsrGraph.
+// Parallel edges are merged into a single edge with the smallest cost.
+class CsrBuilder {
+    int n_;
+    vector<int> from_;
+    vector<int> to_;
+    vector<int> cost_;
+
+public:
+    explicit CsrBuilder(int n) : n_(n) {}
+
+    void add_edge(int u, int v, int c = 0) {
+        from_.push_back(u);
+        to_.push_back(v);
+        cost_.push_back(c);
+    }
+
+    CsrGraph build() const {
+        CsrGraph g;
+        g.offset.assign(n_ + 1, 0);
+        for (size_t i = 0; i < from_.size(); i++) {
+            g.offset[from_[i] + 1]++;
+        }
+        for (int v = 0; v < n_; v++) {
+            g.offset[v + 1] += g.offset[v];
+        }
+
+        // Counting sort by source, then order each row by (target, cost)
+        // so that the cheapest of the parallel edges comes first.
+        vector<pair<int, int> > row(from_.size());
+        vector<int> next(g.offset.begin(), g.offset.end() - 1);
+        for (size_t i = 0; i < from_.size(); i++) {
+            row[next[from_[i]]++] = std::make_pair(to_[i], cost_[i]);
+        }
+
+        g.target.reserve(row.size());
+        g.weight.reserve(row.size());
+        int begin = 0;
+        for (int v = 0; v < n_; v++) {
+            int end = g.offset[v + 1];
+            std::sort(row.begin() + begin, row.begin() + end);
+            g.offset[v] = g.target.size();
+            for (int i = begin; i < end; i++) {
+                if (i == begin || row[i].first != row[i - 1].first) {
+                    g.target.push_back(row[i].first);
+                    g.weight.push_back(row[i].second);
+                }
+            }
+            begin = end;
+        }
+        g.offset[n_] = g.target.size();
+        return g;
+    }
+};
+
 
 // Distances can grow out of int type
 typedef long long Len;
 
+const Len INFINITY = numeric_limits<Len>::max() / 4;
+
+// Indexed D-ary min-heap of (key, node) pairs with decrease-key.
+// Every node is in the heap at most once: position_[v] is the index of v
+// in heap_, or -1 if v is not there. Memory is bounded by the number of nodes.
+template <typename Key, int D = 4>
+class IndexedHeap {
+    vector<pair<Key, int>> heap_;
+    vector<int> position_;
+
+public:
+    explicit IndexedHeap(int n = 0) : position_(n, -1) {}
+
+    bool empty() const { return heap_.empty(); }
+
+    const pair<Key, int>& top() const { return heap_[0]; }
+
+    // Inserts v with the given key, or decreases the key of v if it is smaller.
+    void update(int v, Key key) {
+        int i = position_[v];
+        if (i < 0) {
+            i = heap_.size();
+            heap_.push_back(make_pair(key, v));
+        } else if (!(key < heap_[i].first)) {
+            return;
+        }
+        sift_up(i, make_pair(key, v));
+    }
+
+    pair<Key, int> pop() {
+        pair<Key, int> top = heap_[0];
+        position_[top.second] = -1;
+        pair<Key, int> last = heap_.back();
+        heap_.pop_back();
+        if (!heap_.empty()) {
+            sift_down(0, last);
+        }
+        return top;
+    }
+
+    // Removes the remaining nodes in O(size).
+    void clear() {
+        for (size_t i = 0; i < heap_.size(); ++i) {
+            position_[heap_[i].second] = -1;
+        }
+        heap_.clear();
+    }
+
+private:
+    void place(int i, const pair<Key, int>& entry) {
+        heap_[i] = entry;
+        position_[entry.second] = i;
+    }
+
+    void sift_up(int i, pair<Key, int> entry) {
+        while (i > 0) {
+            int parent = (i - 1) / D;
+            if (!(entry < heap_[parent])) {
+                break;
+            }
+            place(i, heap_[parent]);
+            i = parent;
+        }
+        place(i, entry);
+    }
+
+    void sift_down(int i, pair<Key, int> entry) {
+        int size = heap_.size();
+        while (true) {
+            int first = D * i + 1;
+            if (first >= size) {
+                break;
+            }
+            int last = min(first + D, size);
+            int best = first;
+            for (int c = first + 1; c < last; ++c) {
+                if (heap_[c] < heap_[best]) {
+                    best = c;
+                }
+            }
+            if (!(heap_[best] < entry)) {
+                break;
+            }
+            place(i, heap_[best]);
+            i = best;
+        }
+        place(i, entry);
+    }
+};
+
 // Vector of two priority queues - for forward and backward searches.
 // Each priority queue stores the closest unprocessed node in its head.
-typedef vector<priority_queue<pair<Len, int>,vector<pair<Len,int>>,greater<pair<Len,int>>>> Queue;
-
-const Len INFINITY = numeric_limits<Len>::max() / 4;
+typedef vector<IndexedHeap<Len>> Queue;
 
 class Bidijkstra {
     // Number of nodes
     int n_;
-    // Graph adj_[0] and cost_[0] correspond to the initial graph,
-    // adj_[1] and cost_[1] correspond to the reversed graph.
-    // Graphs are stored as vectors of adjacency lists corresponding
-    // to nodes.
-    // Adjacency list itself is stored in adj_, and the corresponding
-    // edge costs are stored in cost_.
-    Adj adj_;
-    Adj cost_;
-    // distance_[0] stores distances for the forward search,
-    // and distance_[1] stores distances for the backward search.
-    vector<vector<Len>> distance_;
-    // Stores all the nodes visited either by forward or backward search.
-    vector<int> workset_;
-    // Stores a flag for each node which is True iff the node was visited
-    // either by forward or backward search.
-    vector<bool> visited_;
+    // graph_[0] is the initial graph, graph_[1] is the reversed graph.
+    CsrGraph graph_[2];
+
+    // Everything a single query writes to. The graph is shared read-only,
+    // so queries running on different workspaces can run concurrently.
+    struct Workspace {
+        // distance[0] stores distances for the forward search,
+        // and distance[1] stores distances for the backward search.
+        vector<vector<Len>> distance;
+        // Stores all the nodes visited either by forward or backward search.
+        vector<int> workset;
+        // Stores a flag for each node which is True iff the node was visited
+        // either by forward or backward search.
+        vector<bool> visited;
+        // Priority queues of the forward and backward searches, kept between
+        // queries so that their position maps are allocated only once.
+        Queue queue;
+        // Length of the shortest path found so far by the current query.
+        Len best;
+
+        explicit Workspace(int n)
+            : distance(2, vector<Len>(n, INFINITY)), visited(n), queue(2, IndexedHeap<Len>(n)), best(INFINITY)
+        { workset.reserve(n); }
+    };
+    // Workspace of query(), also used by the calling thread of query_batch()
+    Workspace workspace_;
+    // Workspaces of the other threads of query_batch(), kept between batches
+    // and grown when a batch asks for more threads than any before it.
+    vector<Workspace> pool_;
 
 public:
-    Bidijkstra(int n, Adj adj, Adj cost)
-        : n_(n), adj_(adj), cost_(cost), distance_(2, vector<Len>(n, INFINITY)), visited_(n)
-    { workset_.reserve(n); }
+    Bidijkstra(int n, const CsrGraph& graph)
+        : n_(n), graph_{graph, graph.reversed()}, workspace_(n)
+    {}
 
     // Initialize the data structures before new query,
     // clear the changes made by the previous query.
-    void clear() {
-        for (int i = 0; i < workset_.size(); ++i) {
-            int v = workset_[i];
-            distance_[0][v] = distance_[1][v] = INFINITY;
-            visited_[v] = false;
+    // Takes time proportional to the number of nodes the previous query touched.
+    static void clear(Workspace& w) {
+        for (size_t i = 0; i < w.workset.size(); ++i) {
+            int v = w.workset[i];
+            w.distance[0][v] = w.distance[1][v] = INFINITY;
+            w.visited[v] = false;
         }
-        workset_.clear();
+        w.workset.clear();
+        w.queue[0].clear();
+        w.queue[1].clear();
+        w.best = INFINITY;
     }
 
     // Processes visit of either forward or backward search 
     // (determined by value of side), to node v trying to
     // relax the current distance by dist.
-    void visit(Queue& q, int side, int v, Len dist) {
-        // Implement this method yourself
+    static void visit(Workspace& w, int side, int v, Len dist) {
+        if (w.distance[side][v] <= dist) {
+            return;
+        }
+        w.distance[side][v] = dist;
+        w.queue[side].update(v, dist);
+        if (!w.visited[v]) {
+            w.visited[v] = true;
+            w.workset.push_back(v);
+        }
+        if (w.distance[1 - side][v] < INFINITY) {
+            w.best = min(w.best, dist + w.distance[1 - side][v]);
+        }
     }
 
     // Returns the distance from s to t in the graph.
     Len query(int s, int t) {
-        clear();
-        Queue q(2);
-        visit(q, 0, s, 0);
-        visit(q, 1, t, 0);
-        // Implement the rest of the algorithm yourself
+        return query(workspace_, s, t);
+    }
+
+    // Returns the distances for all the (s, t) pairs, answering them on
+    // the given number of threads. Each thread reuses one workspace for
+    // all the queries it takes, and the workspaces are reused by later batches.
+    vector<Len> query_batch(const vector<pair<int, int>>& queries, int threads) {
+        vector<Len> result(queries.size());
+        threads = max(1, min<int>(threads, queries.size()));
+        const int CHUNK = 16;
+        atomic<size_t> next(0);
+        auto worker = [&](Workspace& w) {
+            for (size_t begin = next.fetch_add(CHUNK); begin < queries.size(); begin = next.fetch_add(CHUNK)) {
+                size_t end = min(queries.size(), begin + CHUNK);
+                for (size_t i = begin; i < end; ++i) {
+                    result[i] = query(w, queries[i].first, queries[i].second);
+                }
+            }
+        };
 
-        return -1;
+        while ((int)pool_.size() + 1 < threads) {
+            pool_.emplace_back(n_);
+        }
+        vector<thread> workers;
+        for (int i = 0; i + 1 < threads; ++i) {
+            workers.emplace_back(worker, ref(pool_[i]));
+        }
+        worker(workspace_);
+        for (thread& th : workers) {
+            th.join();
+        }
+        return result;
+    }
+
+private:
+    Len query(Workspace& w, int s, int t) const {
+        clear(w);
+        Queue& q = w.queue;
+        visit(w, 0, s, 0);
+        visit(w, 1, t, 0);
+
+        // Every path shorter than best would have to pass through a node
+        // unprocessed by both searches, so they can stop once the sum of
+        // the queue heads is no less than best.
+        while (!q[0].empty() && !q[1].empty() && q[0].top().first + q[1].top().first < w.best) {
+            int side = q[0].top().first <= q[1].top().first ? 0 : 1;
+            pair<Len, int> top = q[side].pop();
+            int u = top.second;
+            const CsrGraph& g = graph_[side];
+            for (int i = g.offset[u]; i < g.offset[u + 1]; ++i) {
+                visit(w, side, g.target[i], top.first + g.weight[i]);
+            }
+        }
+
+        return w.best == INFINITY ? -1 : w.best;
     }
 };
 
 int main() {
     int n, m;
     scanf("%d%d", &n, &m);
-    Adj adj(2, vector<vector<int>>(n));
-    Adj cost(2, vector<vector<int>>(n));
+    CsrBuilder builder(n);
     for (int i=0; i<m; ++i) {
         int u, v, c;
         scanf("%d%d%d", &u, &v, &c);
-        adj[0][u-1].push_back(v-1);
-        cost[0][u-1].push_back(c);
-        adj[1][v-1].push_back(u-1);
-        cost[1][v-1].push_back(c);
+        builder.add_edge(u-1, v-1, c);
     }
 
-    Bidijkstra bidij(n, adj, cost);
+    Bidijkstra bidij(n, builder.build());
 
     int t;
     scanf("%d", &t);
+    vector<pair<int, int>> queries(t);
     for (int i=0; i<t; ++i) {
         int u, v;
         scanf("%d%d", &u, &v);
-        printf("%lld\n", bidij.query(u-1, v-1));
+        queries[i] = make_pair(u-1, v-1);
+    }
+    vector<Len> distances = bidij.query_batch(queries, thread::hardware_concurrency());
+    for (int i=0; i<t; ++i) {
+        printf("%lld\n", distances[i]);
     }
 }
@@ -0,0 +1,229 @@
+//
+//  heap_benchmark.cpp
+//  Algorithms on Graphs - Programming Project
+//
+//  Compares the lazy priority_queue used by the starters, which pushes a new
+//  entry on every relaxation, with the indexed D-ary heap used by
+//  friend_suggestion, dist_with_coords and dist_preprocess_*.
+//
+//  Usage: heap_benchmark [side] [queries]
+//  Runs one-to-all Dijkstra from random sources on a side x side grid with
+//  random travel times, which behaves like a road network for the heap.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <queue>
+#include <limits>
+#include <utility>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+using namespace std;
+
+typedef long long Len;
+
+const Len INF = numeric_limits<Len>::max() / 4;
+
+// The heap from friend_suggestion.cpp, with size() added for the statistics
+template <typename Key, int D = 4>
+class IndexedHeap {
+    vector<pair<Key, int>> heap_;
+    vector<int> position_;
+
+public:
+    explicit IndexedHeap(int n = 0) : position_(n, -1) {}
+
+    bool empty() const { return heap_.empty(); }
+
+    int size() const { return heap_.size(); }
+
+    const pair<Key, int>& top() const { return heap_[0]; }
+
+    void update(int v, Key key) {
+        int i = position_[v];
+        if (i < 0) {
+            i = heap_.size();
+            heap_.push_back(make_pair(key, v));
+        } else if (!(key < heap_[i].first)) {
+            return;
+        }
+        sift_up(i, make_pair(key, v));
+    }
+
+    pair<Key, int> pop() {
+        pair<Key, int> top = heap_[0];
+        position_[top.second] = -1;
+        pair<Key, int> last = heap_.back();
+        heap_.pop_back();
+        if (!heap_.empty()) {
+            sift_down(0, last);
+        }
+        return top;
+    }
+
+private:
+    void place(int i, const pair<Key, int>& entry) {
+        heap_[i] = entry;
+        position_[entry.second] = i;
+    }
+
+    void sift_up(int i, pair<Key, int> entry) {
+        while (i > 0) {
+            int parent = (i - 1) / D;
+            if (!(entry < heap_[parent])) {
+                break;
+            }
+            place(i, heap_[parent]);
+            i = parent;
+        }
+        place(i, entry);
+    }
+
+    void sift_down(int i, pair<Key, int> entry) {
+        int size = heap_.size();
+        while (true) {
+            int first = D * i + 1;
+            if (first >= size) {
+                break;
+            }
+            int last = min(first + D, size);
+            int best = first;
+            for (int c = first + 1; c < last; ++c) {
+                if (heap_[c] < heap_[best]) {
+                    best = c;
+                }
+            }
+            if (!(heap_[best] < entry)) {
+                break;
+            }
+            place(i, heap_[best]);
+            i = best;
+        }
+        place(i, entry);
+    }
+};
+
+struct Graph {
+    vector<vector<int>> adj;
+    vector<vector<int>> cost;
+};
+
+Graph grid(int side, mt19937& rng) {
+    uniform_int_distribution<int> weight(10, 1000);
+    int n = side * side;
+    Graph g;
+    g.adj.resize(n);
+    g.cost.resize(n);
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int v = r * side + c;
+            int next[2] = {c + 1 < side ? v + 1 : -1, r + 1 < side ? v + side : -1};
+            for (int w : next) {
+                if (w < 0) {
+                    continue;
+                }
+                int l = weight(rng);
+                g.adj[v].push_back(w);
+                g.cost[v].push_back(l);
+                g.adj[w].push_back(v);
+                g.cost[w].push_back(l);
+            }
+        }
+    }
+    return g;
+}
+
+struct Stats {
+    double ms = 0;
+    long long pops = 0;
+    int peak = 0;
+    Len checksum = 0;
+};
+
+Stats lazy_dijkstra(const Graph& g, const vector<int>& sources) {
+    Stats stats;
+    vector<Len> dist(g.adj.size(), INF);
+    auto start = chrono::steady_clock::now();
+    for (int s : sources) {
+        fill(dist.begin(), dist.end(), INF);
+        priority_queue<pair<Len, int>, vector<pair<Len, int>>, greater<pair<Len, int>>> q;
+        dist[s] = 0;
+        q.push(make_pair(0, s));
+        while (!q.empty()) {
+            stats.peak = max(stats.peak, (int)q.size());
+            pair<Len, int> top = q.top();
+            q.pop();
+            ++stats.pops;
+            int u = top.second;
+            if (top.first > dist[u]) {  // redundant entry
+                continue;
+            }
+            for (size_t i = 0; i < g.adj[u].size(); ++i) {
+                int v = g.adj[u][i];
+                if (dist[v] > top.first + g.cost[u][i]) {
+                    dist[v] = top.first + g.cost[u][i];
+                    q.push(make_pair(dist[v], v));
+                }
+            }
+        }
+        stats.checksum += *max_element(dist.begin(), dist.end());
+    }
+    stats.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+template <int D>
+Stats indexed_dijkstra(const Graph& g, const vector<int>& sources) {
+    Stats stats;
+    vector<Len> dist(g.adj.size(), INF);
+    IndexedHeap<Len, D> q(g.adj.size());
+    auto start = chrono::steady_clock::now();
+    for (int s : sources) {
+        fill(dist.begin(), dist.end(), INF);
+        dist[s] = 0;
+        q.update(s, 0);
+        while (!q.empty()) {
+            stats.peak = max(stats.peak, q.size());
+            pair<Len, int> top = q.pop();
+            ++stats.pops;
+            int u = top.second;
+            for (size_t i = 0; i < g.adj[u].size(); ++i) {
+                int v = g.adj[u][i];
+                if (dist[v] > top.first + g.cost[u][i]) {
+                    dist[v] = top.first + g.cost[u][i];
+                    q.update(v, dist[v]);
+                }
+            }
+        }
+        stats.checksum += *max_element(dist.begin(), dist.end());
+    }
+    stats.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+void report(const char* name, const Stats& stats, int queries) {
+    printf("%-12s %10.2f ms/query %12lld pops %10d peak size  checksum %lld\n",
+           name, stats.ms / queries, stats.pops, stats.peak, stats.checksum);
+}
+
+int main(int argc, char** argv) {
+    int side = argc > 1 ? atoi(argv[1]) : 500;
+    int queries = argc > 2 ? atoi(argv[2]) : 20;
+
+    mt19937 rng(12345);
+    Graph g = grid(side, rng);
+    vector<int> sources(queries);
+    uniform_int_distribution<int> node(0, side * side - 1);
+    for (int& s : sources) {
+        s = node(rng);
+    }
+
+    printf("%d nodes, %d queries\n", side * side, queries);
+    report("lazy", lazy_dijkstra(g, sources), queries);
+    report("indexed D=2", indexed_dijkstra<2>(g, sources), queries);
+    report("indexed D=4", indexed_dijkstra<4>(g, sources), queries);
+    report("indexed D=8", indexed_dijkstra<8>(g, sources), queries);
+}
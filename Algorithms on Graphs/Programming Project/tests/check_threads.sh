@@ -0,0 +1,31 @@
+#!/bin/sh
+# Checks dist_preprocess_large on the tests in this directory: every mode answers the
+# queries correctly, and preprocess_parallel() writes the same index file on 1 and on
+# THREADS threads.
+#
+# Usage: check_threads.sh BINARY [THREADS]
+
+BINARY=$1
+THREADS=${2:-4}
+DIR=$(dirname "$0")
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+status=0
+for test in "$DIR"/[0-9][0-9]; do
+    name=$(basename "$test")
+    for mode in "" "--threads 1" "--threads $THREADS"; do
+        "$BINARY" $mode < "$test" | sed 1d > "$TMP/out"
+        if ! diff --strip-trailing-cr -q "$TMP/out" "$test.a" > /dev/null; then
+            echo "$name: wrong answers with options '$mode'"
+            status=1
+        fi
+    done
+    "$BINARY" --threads 1 --save-index "$TMP/1.idx" < "$test" > /dev/null
+    "$BINARY" --threads "$THREADS" --save-index "$TMP/$THREADS.idx" < "$test" > /dev/null
+    if ! cmp -s "$TMP/1.idx" "$TMP/$THREADS.idx"; then
+        echo "$name: index files differ between --threads 1 and --threads $THREADS"
+        status=1
+    fi
+done
+exit $status
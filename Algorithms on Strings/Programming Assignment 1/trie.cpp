@@ -8,65 +8,410 @@
 #include <string>
 #include <iostream>
 #include <vector>
-#include <map>
+#include <algorithm>
+#include <cstdint>
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
 
-using std::map;
 using std::vector;
 using std::string;
 
-typedef map<char, int> edges;
-typedef vector<edges> trie;
-
-trie build_trie(vector<string> & patterns) {
-    trie t;
-    for (size_t i = 0; i < patterns.size(); ++i) {
-        int current_node_key = 0;
+// Trie stored as a double array: the child of state s on byte c is
+// t = base[s] + c when check[t] == s, so an edge costs two ints instead of a
+// map node. It is built at once from all the patterns, sorted, placing the
+// children of each node at the first base where all of their slots are free.
+class DoubleArrayTrie {
+    static const int32_t FREE = -1;
+    // check of the root slot, which is no state's child
+    static const int32_t ROOT = -2;
+    
+    vector<int32_t> base;
+    vector<int32_t> check;
+    vector<bool> terminal;
+    // The distinct bytes on the edges, in the order of char
+    vector<char> alphabet;
+    size_t states;
+    // Slots before this one are almost all used, so the search for a base starts here
+    size_t next_check_pos;
+    
+    struct Range {
+        int32_t state;
+        size_t lo, hi, depth;
+    };
+    
+    void grow(size_t size) {
+        if (size > check.size()) {
+            base.resize(size, 0);
+            check.resize(size, FREE);
+            terminal.resize(size, false);
+        }
+    }
+    
+    int32_t find_base(const vector<unsigned char>& labels) {
+        size_t pos = std::max(next_check_pos, static_cast<size_t>(labels[0]) + 1);
+        size_t start = pos;
+        size_t used = 0;
+        bool first_free = true;
+        for (; ; ++pos) {
+            grow(pos + 256 + 1);
+            if (check[pos] != FREE) {
+                ++used;
+                continue;
+            }
+            if (first_free) {
+                next_check_pos = pos;
+                first_free = false;
+            }
+            size_t b = pos - labels[0];
+            size_t i = 1;
+            while (i < labels.size() && check[b + labels[i]] == FREE) {
+                ++i;
+            }
+            if (i == labels.size()) {
+                break;
+            }
+        }
+        // Skip the scanned slots next time if they are nearly full
+        if (used * 20 >= (pos - start + 1) * 19) {
+            next_check_pos = pos;
+        }
+        return static_cast<int32_t>(pos - labels[0]);
+    }
+    
+public:
+    explicit DoubleArrayTrie(const vector<string>& patterns) : states(1), next_check_pos(1) {
+        grow(256 + 1);
+        check[0] = ROOT;
         
-        for (size_t j = 0; j < patterns[i].size(); ++j) {
+        vector<uint32_t> order(patterns.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = static_cast<uint32_t>(i);
+        }
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return patterns[a] < patterns[b];
+        });
+        order.erase(std::unique(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return patterns[a] == patterns[b];
+        }), order.end());
+        
+        bool seen[256] = {false};
+        vector<Range> stack(1, Range{0, 0, order.size(), 0});
+        vector<unsigned char> labels;
+        vector<size_t> starts;
+        while (!stack.empty()) {
+            Range range = stack.back();
+            stack.pop_back();
             
-            char current_char = patterns[i][j];
+            // The patterns of the range share their first depth bytes, and a
+            // pattern of exactly that length sorts first
+            size_t i = range.lo;
+            if (i < range.hi && patterns[order[i]].size() == range.depth) {
+                terminal[range.state] = true;
+                ++i;
+            }
+            labels.clear();
+            starts.clear();
+            for (; i < range.hi; ++i) {
+                unsigned char c = patterns[order[i]][range.depth];
+                if (labels.empty() || labels.back() != c) {
+                    labels.push_back(c);
+                    starts.push_back(i);
+                }
+            }
+            if (labels.empty()) {
+                continue;
+            }
+            starts.push_back(range.hi);
             
-            if (t.empty()) {
-                
-                edges e;
-                e[current_char] = 1;
-                t.push_back(e);
-                t.push_back(edges());
-                current_node_key = 1;
-                
+            int32_t b = find_base(labels);
+            base[range.state] = b;
+            for (size_t k = labels.size(); k-- > 0; ) {
+                int32_t child = b + labels[k];
+                check[child] = range.state;
+                ++states;
+                seen[labels[k]] = true;
+                stack.push_back(Range{child, starts[k], starts[k + 1], range.depth + 1});
+            }
+        }
+        
+        for (int c = 0; c < 256; ++c) {
+            if (seen[c]) {
+                alphabet.push_back(static_cast<char>(c));
+            }
+        }
+        std::sort(alphabet.begin(), alphabet.end());
+    }
+    
+    int32_t root() const {
+        return 0;
+    }
+    
+    // Child of state on c, or -1
+    int32_t child(int32_t state, char c) const {
+        size_t t = static_cast<size_t>(base[state]) + static_cast<unsigned char>(c);
+        if (base[state] > 0 && t < check.size() && check[t] == state) {
+            return static_cast<int32_t>(t);
+        }
+        return -1;
+    }
+    
+    // Calls f(c, child) for the children of state in the order of c
+    template <typename F>
+    void for_each_child(int32_t state, F f) const {
+        if (base[state] <= 0) {
+            return;
+        }
+        for (char c : alphabet) {
+            int32_t t = child(state, c);
+            if (t >= 0) {
+                f(c, t);
+            }
+        }
+    }
+    
+    bool is_terminal(int32_t state) const {
+        return terminal[state];
+    }
+    
+    // State reached by prefix, or -1 if no pattern starts with it
+    int32_t find(const string& prefix) const {
+        int32_t state = root();
+        for (size_t i = 0; i < prefix.size() && state >= 0; ++i) {
+            state = child(state, prefix[i]);
+        }
+        return state;
+    }
+    
+    // Length of the longest pattern that is a prefix of text, or -1
+    long longest_prefix(const string& text) const {
+        long longest = -1;
+        int32_t state = root();
+        for (size_t i = 0; state >= 0; ++i) {
+            if (terminal[state]) {
+                longest = static_cast<long>(i);
+            }
+            if (i == text.size()) {
+                break;
+            }
+            state = child(state, text[i]);
+        }
+        return longest;
+    }
+    
+    size_t node_count() const {
+        return states;
+    }
+    
+    // Upper bound on the states, for arrays indexed by state
+    size_t state_limit() const {
+        return check.size();
+    }
+};
+
+const int32_t DoubleArrayTrie::FREE;
+const int32_t DoubleArrayTrie::ROOT;
+
+// Read-only trie in the level-order unary degree sequence encoding: the nodes
+// are numbered breadth first, node v contributes one 1 per child followed by
+// a 0, and the k-th 1 is the edge into node k + 1, whose byte is labels[k].
+// This takes about 10 bits per node plus a rank directory of 1/16 of the
+// bits and a sample of every 512th zero, at the cost of a select per step.
+class LoudsTrie {
+    vector<uint64_t> bits;
+    // Ones before every block of 8 words
+    vector<uint32_t> block_rank;
+    // Block holding every 512th zero, which narrows the search of select0
+    vector<uint32_t> zero_block;
+    vector<char> labels;
+    vector<bool> terminal;
+    size_t bit_count;
+    size_t nodes;
+    
+    void push_bit(bool one) {
+        if (bit_count % 64 == 0) {
+            bits.push_back(0);
+        }
+        if (one) {
+            bits.back() |= 1ULL << (bit_count % 64);
+        }
+        ++bit_count;
+    }
+    
+    // Position of the set bit with index k in x
+    static size_t select_in_word(uint64_t x, size_t k) {
+#ifdef __BMI2__
+        return __builtin_ctzll(_pdep_u64(1ULL << k, x));
+#else
+        size_t shift = 0;
+        for (size_t count; k >= (count = __builtin_popcountll(x >> shift & 0xff)); shift += 8) {
+            k -= count;
+        }
+        x >>= shift;
+        for (; k > 0; --k) {
+            x &= x - 1;
+        }
+        return shift + __builtin_ctzll(x);
+#endif
+    }
+    
+    // Position of the zero with index j, counting from 0
+    size_t select0(size_t j) const {
+        // Last block with at most j zeros before it
+        size_t lo = zero_block[j / 512], hi = zero_block[j / 512 + 1] + 1;
+        while (hi - lo > 1) {
+            size_t mid = (lo + hi) / 2;
+            if (mid * 512 - block_rank[mid] <= j) {
+                lo = mid;
             } else {
-                
-                // check if there is a matching edge
-                bool match = false;
-                
-                for (map<char, int>::iterator iter = t[current_node_key].begin();
-                     iter != t[current_node_key].end(); ++iter) {
-                    
-                    if (iter->first == current_char) {
-                        
-                        current_node_key = iter->second;
-                        match = true;
-                        break;
-                        
-                    }
-                }
-                
-                if (!match) {
-                    
-                    // add new node to trie;
-                    t.push_back(edges());
-                    int new_node_key = (int)t.size() - 1;
-                    t[current_node_key][current_char] = new_node_key;
-                    
-                    current_node_key = new_node_key;
-                }
+                hi = mid;
+            }
+        }
+        size_t remaining = j - (lo * 512 - block_rank[lo]);
+        for (size_t w = lo * 8; ; ++w) {
+            uint64_t zeros = ~bits[w];
+            size_t count = __builtin_popcountll(zeros);
+            if (remaining < count) {
+                return w * 64 + select_in_word(zeros, remaining);
+            }
+            remaining -= count;
+        }
+    }
+    
+    // First bit of the run of node v
+    size_t start(int32_t v) const {
+        return v == 0 ? 0 : select0(v - 1) + 1;
+    }
+    
+    // Position of the first zero at or after pos
+    size_t next_zero(size_t pos) const {
+        size_t w = pos / 64;
+        uint64_t zeros = ~bits[w] >> (pos % 64);
+        if (zeros) {
+            return pos + __builtin_ctzll(zeros);
+        }
+        while (!~bits[++w]) {
+        }
+        return w * 64 + __builtin_ctzll(~bits[w]);
+    }
+    
+public:
+    explicit LoudsTrie(const DoubleArrayTrie& trie) : bit_count(0), nodes(0) {
+        vector<int32_t> queue(1, trie.root());
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int32_t state = queue[head];
+            terminal.push_back(trie.is_terminal(state));
+            trie.for_each_child(state, [&](char c, int32_t child) {
+                push_bit(true);
+                labels.push_back(c);
+                queue.push_back(child);
+            });
+            push_bit(false);
+        }
+        nodes = queue.size();
+        // Bits past the end read as ones, so select0 never runs into them
+        if (bit_count % 64) {
+            bits.back() |= ~0ULL << (bit_count % 64);
+        }
+        bits.resize((bits.size() + 7) / 8 * 8 + 8, ~0ULL);
+        for (size_t w = 0, rank = 0; w < bits.size(); ++w) {
+            if (w % 8 == 0) {
+                block_rank.push_back(static_cast<uint32_t>(rank));
+            }
+            rank += __builtin_popcountll(bits[w]);
+        }
+        for (size_t b = 0, zeros = 0; b < block_rank.size(); ++b) {
+            size_t next = b + 1 < block_rank.size() ? (b + 1) * 512 - block_rank[b + 1] : nodes;
+            for (; zeros < next && zeros < nodes; zeros += 512) {
+                zero_block.push_back(static_cast<uint32_t>(b));
             }
         }
+        zero_block.push_back(static_cast<uint32_t>(block_rank.size() - 1));
+    }
+    
+    int32_t root() const {
+        return 0;
+    }
+    
+    // Child of node v on c, or -1
+    int32_t child(int32_t v, char c) const {
+        // The v zeros before the run leave from - v ones before it
+        size_t from = start(v);
+        size_t first = from - v;
+        size_t degree = next_zero(from) - from;
+        const char* begin = labels.data() + first;
+        const char* found = std::lower_bound(begin, begin + degree, c);
+        if (found == begin + degree || *found != c) {
+            return -1;
+        }
+        return static_cast<int32_t>(found - labels.data() + 1);
+    }
+    
+    // Calls f(c, child) for the children of v in the order of c
+    template <typename F>
+    void for_each_child(int32_t v, F f) const {
+        // The v zeros before the run leave from - v ones before it
+        size_t from = start(v);
+        size_t first = from - v;
+        size_t degree = next_zero(from) - from;
+        for (size_t k = first; k < first + degree; ++k) {
+            f(labels[k], static_cast<int32_t>(k + 1));
+        }
+    }
+    
+    bool is_terminal(int32_t v) const {
+        return terminal[v];
+    }
+    
+    // Node reached by prefix, or -1 if no pattern starts with it
+    int32_t find(const string& prefix) const {
+        int32_t v = root();
+        for (size_t i = 0; i < prefix.size() && v >= 0; ++i) {
+            v = child(v, prefix[i]);
+        }
+        return v;
+    }
+    
+    size_t node_count() const {
+        return nodes;
+    }
+    
+    size_t state_limit() const {
+        return nodes;
+    }
+};
+
+// Prints the edges as "parent->child:letter", numbering the nodes in the order
+// the patterns create them and listing the children by letter, which is the
+// output of the map-based trie this replaced.
+template <typename Trie>
+void print_edges(const Trie& t, const vector<string>& patterns) {
+    vector<int32_t> id(t.state_limit(), -1);
+    vector<int32_t> state_of(1, t.root());
+    id[t.root()] = 0;
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        int32_t state = t.root();
+        for (size_t j = 0; j < patterns[i].size(); ++j) {
+            state = t.child(state, patterns[i][j]);
+            if (id[state] < 0) {
+                id[state] = static_cast<int32_t>(state_of.size());
+                state_of.push_back(state);
+            }
+        }
+    }
+    
+    for (size_t i = 0; i < state_of.size(); ++i) {
+        t.for_each_child(state_of[i], [&](char c, int32_t child) {
+            std::cout << i << "->" << id[child] << ":" << c << "\n";
+        });
     }
-    return t;
 }
 
-int main() {
+// Usage: trie [--louds]
+// Prints the edges from the double-array trie, or from its LOUDS encoding.
+int main(int argc, char** argv) {
+    std::ios_base::sync_with_stdio(false);
+    bool louds = argc > 1 && string(argv[1]) == "--louds";
     size_t n;
     std::cin >> n;
     vector<string> patterns;
@@ -76,11 +421,11 @@ int main() {
         patterns.push_back(s);
     }
     
-    trie t = build_trie(patterns);
-    for (size_t i = 0; i < t.size(); ++i) {
-        for (const auto & j : t[i]) {
-            std::cout << i << "->" << j.second << ":" << j.first << "\n";
-        }
+    DoubleArrayTrie t(patterns);
+    if (louds) {
+        print_edges(LoudsTrie(t), patterns);
+    } else {
+        print_edges(t, patterns);
     }
     
     return 0;
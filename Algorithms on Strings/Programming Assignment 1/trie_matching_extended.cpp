@@ -10,6 +10,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <thread>
 
 using namespace std;
 
@@ -104,49 +105,318 @@ Trie build_trie(const vector<string> & patterns)
     return trie;
 }
 
-bool prefix_trie_match(const string &text, const Trie &trie)
+// Failure and output links shared by both automata below. fail[s] is the
+// state of the longest proper suffix of s that is in the trie, out[s] the
+// nearest state on the failure chain of s, s included, that ends a pattern
+// (NA if none), and depth[s] the length of s.
+struct Links
 {
-    size_t pos = 0;
-    Node current_node = trie[0];
+    vector<int> fail;
+    vector<int> out;
+    vector<int> depth;
+};
+
+// Aho-Corasick automaton over the DNA trie of build_trie(). The transitions of
+// every state are completed with the failure links into a dense table of
+// Letters entries per state, so the text is matched in one pass with a single
+// lookup per character.
+struct DnaAutomaton
+{
+    vector<int> delta;
+    Links links;
     
-    while (true)
+    DnaAutomaton (const Trie& trie, const vector<string>& patterns)
     {
-        if (current_node.pattern_end)
+        size_t count = trie.size();
+        delta.assign(count * Letters, 0);
+        links.fail.assign(count, 0);
+        links.out.assign(count, NA);
+        links.depth.assign(count, 0);
+        
+        for (size_t i = 0; i < patterns.size(); ++i)
         {
-            return true;
+            int state = 0;
+            for (size_t j = 0; j < patterns[i].size(); ++j)
+            {
+                state = trie[state].next[letter_to_index(patterns[i][j])];
+            }
+            
+            if (state != 0)
+            {
+                links.out[state] = state;
+            }
         }
-        else if (!good_letter(text[pos]) ||
-                 current_node.next[letter_to_index(text[pos])] == NA)
+        
+        // Breadth first, so the failure link of a state is done before its children
+        vector<int> queue(1, 0);
+        for (size_t head = 0; head < queue.size(); ++head)
         {
-            return false;
+            int state = queue[head];
+            for (int c = 0; c < Letters; ++c)
+            {
+                int child = trie[state].next[c];
+                if (child == NA)
+                {
+                    delta[state * Letters + c] = state == 0 ? 0 : delta[links.fail[state] * Letters + c];
+                    continue;
+                }
+                
+                delta[state * Letters + c] = child;
+                links.fail[child] = state == 0 ? 0 : delta[links.fail[state] * Letters + c];
+                links.depth[child] = links.depth[state] + 1;
+                if (links.out[child] == NA)
+                {
+                    links.out[child] = links.out[links.fail[child]];
+                }
+                queue.push_back(child);
+            }
         }
-        else
+    }
+    
+    int next (int state, char letter) const
+    {
+        return good_letter(letter) ? delta[state * Letters + letter_to_index(letter)] : 0;
+    }
+};
+
+int const Bytes = 256;
+
+// Aho-Corasick automaton for patterns over any bytes. The trie is stored as a
+// double array: the child of state s on byte c is t = base[s] + c when
+// check[t] == s. Missing transitions follow the failure links, which costs
+// amortized constant time per character.
+struct DoubleArrayAutomaton
+{
+    vector<int> base;
+    vector<int> check;
+    Links links;
+    
+    explicit DoubleArrayAutomaton (const vector<string>& patterns)
+    {
+        // Plain trie with sorted children first
+        vector<vector<pair<unsigned char, int> > > children(1);
+        vector<bool> ends(1, false);
+        for (size_t i = 0; i < patterns.size(); ++i)
+        {
+            int node = 0;
+            for (size_t j = 0; j < patterns[i].size(); ++j)
+            {
+                unsigned char c = patterns[i][j];
+                vector<pair<unsigned char, int> >& edges = children[node];
+                vector<pair<unsigned char, int> >::iterator it =
+                    lower_bound(edges.begin(), edges.end(), make_pair(c, 0));
+                if (it != edges.end() && it->first == c)
+                {
+                    node = it->second;
+                    continue;
+                }
+                
+                int child = (int) children.size();
+                edges.insert(it, make_pair(c, child));
+                children.push_back(vector<pair<unsigned char, int> >());
+                ends.push_back(false);
+                node = child;
+            }
+            
+            if (node != 0)
+            {
+                ends[node] = true;
+            }
+        }
+        
+        // Place the children of every node at the first base where all of
+        // their slots are free, breadth first from the root at slot 0
+        vector<int> slot(children.size(), 0);
+        base.assign(1, 0);
+        check.assign(1, NA);
+        links.fail.assign(1, 0);
+        links.out.assign(1, NA);
+        links.depth.assign(1, 0);
+        size_t first_free = 1;
+        vector<int> queue(1, 0);
+        for (size_t head = 0; head < queue.size(); ++head)
         {
-            current_node = trie[current_node.next[letter_to_index(text[pos])]];
-            ++pos;
+            int node = queue[head];
+            int state = slot[node];
+            const vector<pair<unsigned char, int> >& edges = children[node];
+            if (edges.empty())
+            {
+                continue;
+            }
+            
+            while (first_free < check.size() && check[first_free] != NA)
+            {
+                ++first_free;
+            }
+            
+            int b = max(1, (int) first_free - edges[0].first);
+            while (!fits(b, edges))
+            {
+                ++b;
+            }
+            
+            base[state] = b;
+            for (size_t i = 0; i < edges.size(); ++i)
+            {
+                int child = b + edges[i].first;
+                grow(child + 1);
+                check[child] = state;
+                slot[edges[i].second] = child;
+                links.depth[child] = links.depth[state] + 1;
+                queue.push_back(edges[i].second);
+            }
+        }
+        
+        // Failure links in the same breadth first order
+        for (size_t head = 1; head < queue.size(); ++head)
+        {
+            int node = queue[head];
+            int state = slot[node];
+            for (size_t i = 0; i < children[node].size(); ++i)
+            {
+                int child = slot[children[node][i].second];
+                links.fail[child] = state == 0 ? 0 : next(links.fail[state], children[node][i].first);
+            }
+            
+            links.out[state] = ends[node] ? state : links.out[links.fail[state]];
+        }
+    }
+    
+    int next (int state, char letter) const
+    {
+        unsigned char c = letter;
+        while (true)
+        {
+            size_t t = (size_t) base[state] + c;
+            if (base[state] > 0 && t < check.size() && check[t] == state)
+            {
+                return (int) t;
+            }
+            
+            if (state == 0)
+            {
+                return 0;
+            }
+            
+            state = links.fail[state];
+        }
+    }
+    
+private:
+    bool fits (int b, const vector<pair<unsigned char, int> >& edges) const
+    {
+        for (size_t i = 0; i < edges.size(); ++i)
+        {
+            size_t t = (size_t) b + edges[i].first;
+            if (t < check.size() && check[t] != NA)
+            {
+                return false;
+            }
+        }
+        
+        return true;
+    }
+    
+    void grow (size_t size)
+    {
+        if (size > check.size())
+        {
+            base.resize(size, 0);
+            check.resize(size, NA);
+            links.fail.resize(size, 0);
+            links.out.resize(size, NA);
+            links.depth.resize(size, 0);
+        }
+    }
+};
+
+// Runs the automaton over text[begin, stop) from its root and sets found[i]
+// for every pattern occurrence starting at i in [begin, end).
+template <typename Automaton>
+void scan (const Automaton& automaton, const string& text, size_t begin, size_t end, size_t stop,
+           vector<char>& found)
+{
+    const Links& links = automaton.links;
+    int state = 0;
+    for (size_t i = begin; i < stop; ++i)
+    {
+        state = automaton.next(state, text[i]);
+        for (int match = links.out[state]; match != NA; match = links.out[links.fail[match]])
+        {
+            size_t start = i + 1 - links.depth[match];
+            if (start >= begin && start < end)
+            {
+                found[start] = true;
+            }
         }
     }
 }
 
-vector <size_t> solve (const string& text, int n, const vector <string>& patterns)
+// Splits the text into one chunk of start positions per thread. Each chunk is
+// scanned from its start to its end plus the longest pattern minus one, so
+// every occurrence is found by the chunk it starts in.
+template <typename Automaton>
+vector<size_t> match_all (const Automaton& automaton, const string& text, size_t max_length, int threads)
 {
-    vector<size_t> result;
-    Trie trie = build_trie(patterns);
-    size_t pos = 0;
+    size_t const MIN_CHUNK = 1 << 16;
+    size_t chunks = max((size_t) 1, min((size_t) threads, text.size() / MIN_CHUNK));
+    size_t chunk = (text.size() + chunks - 1) / chunks;
+    vector<char> found(text.size(), false);
     
-    while (pos < text.size())
+    vector<thread> pool;
+    for (size_t c = 0; c < chunks; ++c)
     {
-        if (prefix_trie_match(text.substr(pos), trie))
+        size_t begin = min(text.size(), c * chunk);
+        size_t end = min(text.size(), begin + chunk);
+        size_t stop = min(text.size(), end + max_length - 1);
+        if (c + 1 == chunks)
         {
-            result.push_back(pos);
+            scan(automaton, text, begin, end, stop, found);
+        }
+        else
+        {
+            pool.push_back(thread([&, begin, end, stop]() { scan(automaton, text, begin, end, stop, found); }));
+        }
+    }
+    
+    for (size_t i = 0; i < pool.size(); ++i)
+    {
+        pool[i].join();
+    }
+    
+    vector<size_t> result;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (found[i])
+        {
+            result.push_back(i);
         }
-        
-        ++pos;
     }
     
     return result;
 }
 
+vector <size_t> solve (const string& text, int n, const vector <string>& patterns, int threads)
+{
+    size_t max_length = 1;
+    bool dna = true;
+    for (size_t i = 0; i < patterns.size(); ++i)
+    {
+        max_length = max(max_length, patterns[i].size());
+        for (size_t j = 0; j < patterns[i].size(); ++j)
+        {
+            dna = dna && good_letter(patterns[i][j]);
+        }
+    }
+    
+    if (dna)
+    {
+        return match_all(DnaAutomaton(build_trie(patterns), patterns), text, max_length, threads);
+    }
+    
+    return match_all(DoubleArrayAutomaton(patterns), text, max_length, threads);
+}
+
 int main (void)
 {
     string text;
@@ -162,7 +432,7 @@ int main (void)
     }
     
     vector <size_t> ans;
-    ans = solve (text, n, patterns);
+    ans = solve (text, n, patterns, max(1u, thread::hardware_concurrency()));
     
     for (int i = 0; i < (int) ans.size (); i++)
     {
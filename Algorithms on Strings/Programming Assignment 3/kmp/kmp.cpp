@@ -6,9 +6,15 @@
 //
 
 #include <cstdio>
+#include <cstring>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 using std::cin;
 using std::string;
@@ -44,29 +50,176 @@ vector<int> compute_prefix_function(const string& text)
     return result;
 }
 
+// KMP matcher that keeps only the prefix function of the pattern and the
+// length of the match in progress, so a text can be fed to it in pieces of
+// any size and searched in memory independent of its length.
+class StreamingMatcher
+{
+public:
+    explicit StreamingMatcher(const string& pattern)
+    : pattern(pattern), state(0), offset(0)
+    {
+        if (!pattern.empty())
+        {
+            failure = compute_prefix_function(pattern);
+        }
+    }
+    
+    // Feeds the next size characters of the text, calling on_match(position)
+    // for every occurrence of the pattern ending in them, where position is
+    // counted from the start of the whole text.
+    template <typename Callback>
+    void feed(const char* data, size_t size, Callback on_match)
+    {
+        int p = (int) pattern.length();
+        if (p == 0)
+        {
+            return;
+        }
+        
+        const char* end = data + size;
+        for (const char* c = data; c < end; ++c)
+        {
+            if (state == 0)
+            {
+                // Nothing matched, skip straight to the next first character
+                c = (const char*) memchr(c, pattern[0], end - c);
+                if (c == NULL)
+                {
+                    break;
+                }
+            }
+            
+            while (state > 0 && *c != pattern[state])
+            {
+                state = failure[state - 1];
+            }
+            
+            if (*c == pattern[state])
+            {
+                state++;
+            }
+            
+            if (state == p)
+            {
+                on_match(offset + (c - data) + 1 - p);
+                state = failure[p - 1];
+            }
+        }
+        
+        offset += size;
+    }
+    
+private:
+    string pattern;
+    vector<int> failure;
+    int state;
+    // Characters fed so far
+    uint64_t offset;
+};
+
+// Feeds everything that can be read from fd to the matcher.
+// Returns false on a read error.
+template <typename Callback>
+bool search_fd(int fd, StreamingMatcher& matcher, Callback on_match)
+{
+    const size_t BUFFER_SIZE = 1 << 20;
+    vector<char> buffer(BUFFER_SIZE);
+    
+    while (true)
+    {
+        ssize_t n = read(fd, buffer.data(), BUFFER_SIZE);
+        if (n == 0)
+        {
+            return true;
+        }
+        
+        if (n < 0)
+        {
+            return false;
+        }
+        
+        matcher.feed(buffer.data(), n, on_match);
+    }
+}
+
+// Searches the file at path, mapped into memory when possible and read
+// through a buffer otherwise. Returns false if the file cannot be read.
+template <typename Callback>
+bool search_file(const char* path, StreamingMatcher& matcher, Callback on_match)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    
+    struct stat info;
+    bool ok;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+    {
+        data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    
+    if (data != MAP_FAILED)
+    {
+        madvise(data, info.st_size, MADV_SEQUENTIAL);
+        matcher.feed((const char*) data, info.st_size, on_match);
+        munmap(data, info.st_size);
+        ok = true;
+    }
+    
+    else
+    {
+        ok = search_fd(fd, matcher, on_match);
+    }
+    
+    close(fd);
+    return ok;
+}
+
 // Find all occurrences of the pattern in the text and return a
 // vector with all positions in the text (starting from 0) where
 // the pattern starts in the text.
 vector<int> find_pattern(const string& pattern, const string& text)
 {
     vector<int> result;
-    int p = (int) pattern.length();
-    string str = pattern + '$' + text;
-    vector<int> prefix_function = compute_prefix_function(str);
-    
-    for (int i = p + 1; i < str.length(); ++i)
+    StreamingMatcher matcher(pattern);
+    matcher.feed(text.data(), text.length(), [&](uint64_t position)
     {
-        if (prefix_function[i] == p)
-        {
-            result.push_back(i - (2 * p));
-        }
-    }
+        result.push_back((int) position);
+    });
     
     return result;
 }
 
-int main()
+// Usage: kmp
+//        kmp --stream PATTERN [FILE]
+// The first form reads the pattern and the text from the standard input. The
+// second searches FILE, or the standard input if it is missing, as a stream of
+// bytes and prints the positions as they are found.
+int main(int argc, char** argv)
 {
+    if (argc >= 3 && string(argv[1]) == "--stream")
+    {
+        StreamingMatcher matcher(argv[2]);
+        auto print = [](uint64_t position)
+        {
+            printf("%llu ", (unsigned long long) position);
+        };
+        bool ok = argc >= 4 ? search_file(argv[3], matcher, print) : search_fd(0, matcher, print);
+        printf("\n");
+        
+        if (!ok)
+        {
+            perror(argc >= 4 ? argv[3] : "stdin");
+            return 1;
+        }
+        
+        return 0;
+    }
+    
     string pattern, text;
     cin >> pattern;
     cin >> text;
@@ -80,4 +233,3 @@ int main()
     printf("\n");
     return 0;
 }
-
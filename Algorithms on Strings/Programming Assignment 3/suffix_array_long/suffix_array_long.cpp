@@ -8,6 +8,8 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <cstdint>
 
 using std::cin;
 using std::cout;
@@ -15,176 +17,310 @@ using std::endl;
 using std::string;
 using std::vector;
 
-const size_t NUM_CHARS = 5;
-
-size_t get_char_index(char c)
+// SA-IS (Nong, Zhang and Chan): sorts the LMS suffixes by induced sorting,
+// names the LMS substrings, recurses on the reduced string if two of them are
+// equal, and induces the order of all the suffixes from the sorted LMS
+// suffixes. The end of the text acts as a sentinel smaller than every
+// character, and the reduced string and its suffix array are kept inside sa,
+// so the memory beyond the text and sa is one bit per character plus the
+// buckets.
+template <typename Index>
+class SuffixSorter
 {
-    switch (c)
+public:
+    static const Index EMPTY = static_cast<Index>(-1);
+
+    template <typename Char>
+    static void sort(const Char* text, Index* sa, Index n, Index alphabet_size)
     {
-        case 'A':
-            return 1;
-            break;
+        if (n == 0)
+        {
+            return;
+        }
 
-        case 'C':
-            return 2;
-            break;
+        if (n == 1)
+        {
+            sa[0] = 0;
+            return;
+        }
 
-        case 'G':
-            return 3;
-            break;
+        // S-type suffixes are smaller than the suffix after them
+        vector<bool> s_type(n, false);
+        for (Index i = n - 1; i-- > 0; )
+        {
+            s_type[i] = text[i] < text[i + 1] || (text[i] == text[i + 1] && s_type[i + 1]);
+        }
 
-        case 'T':
-            return 4;
-            break;
+        vector<Index> bucket(alphabet_size);
 
-        default:
-            return 0;
-            break;
-    }
-}
+        // Place the LMS suffixes at the ends of their buckets and induce
+        bucket_ends(text, n, bucket, true);
+        std::fill(sa, sa + n, EMPTY);
+        for (Index i = 1; i < n; ++i)
+        {
+            if (is_lms(s_type, i))
+            {
+                sa[--bucket[text[i]]] = i;
+            }
+        }
+        induce(text, sa, n, s_type, bucket);
 
-// A stable sort returning indeces of text lexicographically ordered.
-vector<size_t> sort_characters(const string& text)
-{
-    vector<size_t> order(text.length());
-    vector<size_t> count(NUM_CHARS);
+        // Gather the LMS suffixes, now sorted by their LMS substrings
+        Index m = 0;
+        for (Index i = 0; i < n; ++i)
+        {
+            if (is_lms(s_type, sa[i]))
+            {
+                sa[m++] = sa[i];
+            }
+        }
 
-    for (size_t i = 0; i < text.length(); ++i)
-    {
-        count[get_char_index(text[i])] += 1;
-    }
+        // Name the LMS substrings in order, storing the name of the one at
+        // position p in sa[m + p / 2], which is free since LMS positions are
+        // at least two apart
+        std::fill(sa + m, sa + n, EMPTY);
+        Index names = 0;
+        Index previous = EMPTY;
+        for (Index i = 0; i < m; ++i)
+        {
+            Index p = sa[i];
+            if (previous == EMPTY || !same_lms_substring(text, n, s_type, p, previous))
+            {
+                ++names;
+            }
+            previous = p;
+            sa[m + p / 2] = names - 1;
+        }
 
-    for (size_t j = 1; j < NUM_CHARS; ++j)
-    {
-        count[j] = count[j] + count[j - 1];
-    }
+        // Reduced string in text order at the end of sa
+        Index* reduced = sa + n - m;
+        for (Index i = n, j = n; i-- > m; )
+        {
+            if (sa[i] != EMPTY)
+            {
+                sa[--j] = sa[i];
+            }
+        }
 
-    size_t i = text.length();
+        // Suffix array of the reduced string in sa[0, m)
+        if (names < m)
+        {
+            sort(reduced, sa, m, names);
+        }
+        else
+        {
+            for (Index i = 0; i < m; ++i)
+            {
+                sa[reduced[i]] = i;
+            }
+        }
 
-    while (i > 0)
+        // Back from reduced positions to text positions
+        for (Index i = 1, j = 0; i < n; ++i)
+        {
+            if (is_lms(s_type, i))
+            {
+                reduced[j++] = i;
+            }
+        }
+        for (Index i = 0; i < m; ++i)
+        {
+            sa[i] = reduced[sa[i]];
+        }
+        std::fill(sa + m, sa + n, EMPTY);
+
+        // The sorted LMS suffixes go to the ends of their buckets, largest
+        // first so that none is overwritten before it is moved
+        bucket_ends(text, n, bucket, true);
+        for (Index i = m; i-- > 0; )
+        {
+            Index p = sa[i];
+            sa[i] = EMPTY;
+            sa[--bucket[text[p]]] = p;
+        }
+        induce(text, sa, n, s_type, bucket);
+    }
+
+private:
+    static bool is_lms(const vector<bool>& s_type, Index i)
     {
-        --i;
-        size_t c = get_char_index(text[i]);
-        count[c] -= 1;
-        order[count[c]] = i;
+        return i != EMPTY && i > 0 && s_type[i] && !s_type[i - 1];
     }
 
-    return order;
-}
+    // Start or end of the bucket of every character
+    template <typename Char>
+    static void bucket_ends(const Char* text, Index n, vector<Index>& bucket, bool ends)
+    {
+        std::fill(bucket.begin(), bucket.end(), 0);
+        for (Index i = 0; i < n; ++i)
+        {
+            ++bucket[text[i]];
+        }
 
-// Returns the equivalence classes of the characters of text.
-vector<size_t> compute_character_classes(const string& text,
-                                         const vector<size_t>& order)
-{
-    vector<size_t> classes(text.length());
-    classes[order[0]] = 0;
-    size_t current_class = 0;
+        Index sum = 0;
+        for (size_t c = 0; c < bucket.size(); ++c)
+        {
+            sum += bucket[c];
+            bucket[c] = ends ? sum : sum - bucket[c];
+        }
+    }
 
-    for (size_t i = 1; i < text.length(); ++i)
+    // Sorts the L-type suffixes from the LMS suffixes in sa, then the S-type
+    // suffixes from the L-type ones
+    template <typename Char>
+    static void induce(const Char* text, Index* sa, Index n, const vector<bool>& s_type,
+                       vector<Index>& bucket)
     {
-        if (text[order[i]] != text[order[i - 1]])
+        bucket_ends(text, n, bucket, false);
+        // The sentinel comes first and precedes the last suffix, which is L-type
+        sa[bucket[text[n - 1]]++] = n - 1;
+        for (Index i = 0; i < n; ++i)
         {
-            ++current_class;
+            Index p = sa[i];
+            if (p != EMPTY && p > 0 && !s_type[p - 1])
+            {
+                sa[bucket[text[p - 1]]++] = p - 1;
+            }
         }
 
-        classes[order[i]] =  current_class;
+        bucket_ends(text, n, bucket, true);
+        for (Index i = n; i-- > 0; )
+        {
+            Index p = sa[i];
+            if (p != EMPTY && p > 0 && s_type[p - 1])
+            {
+                sa[--bucket[text[p - 1]]] = p - 1;
+            }
+        }
     }
 
-    return classes;
+    // Whether the LMS substrings at a and b, each running to the next LMS
+    // position or to the sentinel, are equal
+    template <typename Char>
+    static bool same_lms_substring(const Char* text, Index n, const vector<bool>& s_type,
+                                   Index a, Index b)
+    {
+        for (Index d = 0; ; ++d)
+        {
+            if (a + d == n || b + d == n || text[a + d] != text[b + d] ||
+                s_type[a + d] != s_type[b + d])
+            {
+                return false;
+            }
+
+            if (d > 0 && is_lms(s_type, a + d))
+            {
+                return true;
+            }
+        }
+    }
+};
+
+template <typename Index>
+const Index SuffixSorter<Index>::EMPTY;
+
+/*  Build suffix array of the string text and return a vector result of the same length
+ *  as the text such that the value result[i] is the index (0-based) in text where the
+ *  i-th lexicographically smallest suffix of text starts. Index is uint32_t for texts
+ *  shorter than 2^32 - 1 characters, which halves the memory, and uint64_t otherwise.
+ */
+template <typename Index>
+vector<Index> BuildSuffixArray(const string& text)
+{
+    vector<Index> suffix_array(text.length());
+    SuffixSorter<Index>::sort(reinterpret_cast<const unsigned char*>(text.data()),
+                              suffix_array.data(), static_cast<Index>(text.length()), 256);
+    return suffix_array;
 }
 
-// Given ordered partial cyclic shifts, sort shifts of doubled length.
-vector<size_t> sort_doubled(const string& text,
-                            size_t length,
-                            const vector<size_t>& order,
-                            const vector<size_t>& classes)
+// Kasai et al.: lcp[i] is the length of the longest common prefix of the
+// suffixes at ranks i and i + 1. The suffixes are visited in text order, and
+// the prefix shared with the next suffix in rank shrinks by at most one per
+// step, so the whole array takes O(n). rank is filled with the inverse of the
+// suffix array on the way.
+template <typename Index>
+vector<Index> BuildLcpArray(const string& text, const vector<Index>& suffix_array,
+                            vector<Index>& rank)
 {
-    size_t s = text.length();
-    vector<size_t> new_order(s);
-    vector<size_t> count(s, 0);
+    size_t n = text.length();
+    vector<Index> lcp(n > 0 ? n - 1 : 0);
+    rank.resize(n);
 
-    for (size_t i = 0; i < s; ++i)
+    for (size_t i = 0; i < n; ++i)
     {
-        count[classes[i]] += 1;
+        rank[suffix_array[i]] = static_cast<Index>(i);
     }
 
-    for (size_t j = 1; j < s; ++j)
-    {
-        count[j] += count[j - 1];
-    }
-
-    size_t i = s;
+    size_t common = 0;
 
-    while (i > 0)
+    for (size_t p = 0; p < n; ++p)
     {
-        --i;
-        size_t start = (order[i] - length + s) % s;
-        size_t cl = classes[start];
-        count[cl] -= 1;
-        new_order[count[cl]] = start;
-    }
-
-    return new_order;
-}
+        size_t r = rank[p];
 
-// Update the equivalence classes of ordered cyclic shifts.
-vector<size_t> update_classes(const vector<size_t>& order,
-                              const vector<size_t> classes, size_t length)
-{
-    size_t n = order.size();
-    vector<size_t> new_classes(n);
-    new_classes[order[0]] = 0;
+        if (r + 1 == n)
+        {
+            common = 0;
+            continue;
+        }
 
-    for (size_t i = 1; i < n; ++i)
-    {
-        size_t cur = order[i];
-        size_t prev = order[i - 1];
-        size_t mid = (cur + length) % n;
-        size_t mid_prev = (prev + length) % n;
+        size_t q = suffix_array[r + 1];
 
-        if (classes[cur] != classes[prev] || classes[mid] != classes[mid_prev])
+        while (p + common < n && q + common < n && text[p + common] == text[q + common])
         {
-            new_classes[cur] = new_classes[prev] + 1;
+            ++common;
         }
-        else
+
+        lcp[r] = static_cast<Index>(common);
+
+        if (common > 0)
         {
-            new_classes[cur] = new_classes[prev];
+            --common;
         }
     }
 
-    return new_classes;
+    return lcp;
 }
 
-// Build suffix array of the string text and
-// return a vector result of the same length as the text
-// such that the value result[i] is the index (0-based)
-// in text where the i-th lexicographically smallest
-// suffix of text starts.
-vector<size_t> BuildSuffixArray(const string& text)
+// Prints the suffix array and, with print_lcp, the LCP array on the next line,
+// which is the input suffix_tree_from_array expects after the text
+template <typename Index>
+void PrintSuffixArray(const string& text, bool print_lcp)
 {
-    vector<size_t> order = sort_characters(text);
-    vector<size_t> classes = compute_character_classes(text, result);
-    size_t l = 1;
+    vector<Index> suffix_array = BuildSuffixArray<Index>(text);
 
-    while (l < text.length())
+    for (size_t i = 0; i < suffix_array.size(); ++i)
     {
-        result = sort_doubled(text, l, order, classes);
-        classes = update_classes(order, classes, l);
-        l = 2 * l;
+        cout << suffix_array[i] << ' ';
     }
 
-    return order;
+    if (print_lcp)
+    {
+        vector<Index> rank;
+        vector<Index> lcp = BuildLcpArray(text, suffix_array, rank);
+        cout << '\n';
+
+        for (size_t i = 0; i < lcp.size(); ++i)
+        {
+            cout << lcp[i] << ' ';
+        }
+    }
 }
 
-int main()
+// Usage: suffix_array_long [--lcp]
+int main(int argc, char** argv)
 {
+    std::ios_base::sync_with_stdio(false);
+    bool print_lcp = argc > 1 && string(argv[1]) == "--lcp";
     string text;
     cin >> text;
-    vector<size_t> suffix_array = BuildSuffixArray(text);
 
-    for (size_t i = 0; i < suffix_array.size(); ++i)
+    if (text.length() < UINT32_MAX)
     {
-        cout << suffix_array[i] << ' ';
+        PrintSuffixArray<uint32_t>(text, print_lcp);
+    }
+    else
+    {
+        PrintSuffixArray<uint64_t>(text, print_lcp);
     }
 
     return 0;
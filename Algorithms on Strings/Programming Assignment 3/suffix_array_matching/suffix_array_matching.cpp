@@ -9,251 +9,755 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <cstdint>
 
 using std::cout;
 using std::endl;
 using std::cin;
 using std::string;
 using std::vector;
+using std::pair;
+using std::make_pair;
 
-const size_t NUM_CHARS = 5;
-
-size_t get_char_index(char c)
+// SA-IS (Nong, Zhang and Chan): sorts the LMS suffixes by induced sorting,
+// names the LMS substrings, recurses on the reduced string if two of them are
+// equal, and induces the order of all the suffixes from the sorted LMS
+// suffixes. The end of the text acts as a sentinel smaller than every
+// character, and the reduced string and its suffix array are kept inside sa,
+// so the memory beyond the text and sa is one bit per character plus the
+// buckets.
+template <typename Index>
+class SuffixSorter
 {
-    switch (c)
+public:
+    static const Index EMPTY = static_cast<Index>(-1);
+
+    template <typename Char>
+    static void sort(const Char* text, Index* sa, Index n, Index alphabet_size)
     {
-        case 'A':
-            return 1;
-            break;
-            
-        case 'C':
-            return 2;
-            break;
-            
-        case 'G':
-            return 3;
-            break;
-            
-        case 'T':
-            return 4;
-            break;
-            
-        default:
-            return 0;
-            break;
+        if (n == 0)
+        {
+            return;
+        }
+
+        if (n == 1)
+        {
+            sa[0] = 0;
+            return;
+        }
+
+        // S-type suffixes are smaller than the suffix after them
+        vector<bool> s_type(n, false);
+        for (Index i = n - 1; i-- > 0; )
+        {
+            s_type[i] = text[i] < text[i + 1] || (text[i] == text[i + 1] && s_type[i + 1]);
+        }
+
+        vector<Index> bucket(alphabet_size);
+
+        // Place the LMS suffixes at the ends of their buckets and induce
+        bucket_ends(text, n, bucket, true);
+        std::fill(sa, sa + n, EMPTY);
+        for (Index i = 1; i < n; ++i)
+        {
+            if (is_lms(s_type, i))
+            {
+                sa[--bucket[text[i]]] = i;
+            }
+        }
+        induce(text, sa, n, s_type, bucket);
+
+        // Gather the LMS suffixes, now sorted by their LMS substrings
+        Index m = 0;
+        for (Index i = 0; i < n; ++i)
+        {
+            if (is_lms(s_type, sa[i]))
+            {
+                sa[m++] = sa[i];
+            }
+        }
+
+        // Name the LMS substrings in order, storing the name of the one at
+        // position p in sa[m + p / 2], which is free since LMS positions are
+        // at least two apart
+        std::fill(sa + m, sa + n, EMPTY);
+        Index names = 0;
+        Index previous = EMPTY;
+        for (Index i = 0; i < m; ++i)
+        {
+            Index p = sa[i];
+            if (previous == EMPTY || !same_lms_substring(text, n, s_type, p, previous))
+            {
+                ++names;
+            }
+            previous = p;
+            sa[m + p / 2] = names - 1;
+        }
+
+        // Reduced string in text order at the end of sa
+        Index* reduced = sa + n - m;
+        for (Index i = n, j = n; i-- > m; )
+        {
+            if (sa[i] != EMPTY)
+            {
+                sa[--j] = sa[i];
+            }
+        }
+
+        // Suffix array of the reduced string in sa[0, m)
+        if (names < m)
+        {
+            sort(reduced, sa, m, names);
+        }
+        else
+        {
+            for (Index i = 0; i < m; ++i)
+            {
+                sa[reduced[i]] = i;
+            }
+        }
+
+        // Back from reduced positions to text positions
+        for (Index i = 1, j = 0; i < n; ++i)
+        {
+            if (is_lms(s_type, i))
+            {
+                reduced[j++] = i;
+            }
+        }
+        for (Index i = 0; i < m; ++i)
+        {
+            sa[i] = reduced[sa[i]];
+        }
+        std::fill(sa + m, sa + n, EMPTY);
+
+        // The sorted LMS suffixes go to the ends of their buckets, largest
+        // first so that none is overwritten before it is moved
+        bucket_ends(text, n, bucket, true);
+        for (Index i = m; i-- > 0; )
+        {
+            Index p = sa[i];
+            sa[i] = EMPTY;
+            sa[--bucket[text[p]]] = p;
+        }
+        induce(text, sa, n, s_type, bucket);
     }
-}
 
-// A stable sort returning indeces of text lexicographically ordered.
-vector<size_t> sort_characters(const string& text)
-{
-    vector<size_t> order(text.length());
-    vector<size_t> count(NUM_CHARS);
-    
-    for (size_t i = 0; i < text.length(); ++i)
+private:
+    static bool is_lms(const vector<bool>& s_type, Index i)
     {
-        count[get_char_index(text[i])] += 1;
+        return i != EMPTY && i > 0 && s_type[i] && !s_type[i - 1];
     }
-    
-    for (size_t j = 1; j < NUM_CHARS; ++j)
+
+    // Start or end of the bucket of every character
+    template <typename Char>
+    static void bucket_ends(const Char* text, Index n, vector<Index>& bucket, bool ends)
     {
-        count[j] = count[j] + count[j - 1];
+        std::fill(bucket.begin(), bucket.end(), 0);
+        for (Index i = 0; i < n; ++i)
+        {
+            ++bucket[text[i]];
+        }
+
+        Index sum = 0;
+        for (size_t c = 0; c < bucket.size(); ++c)
+        {
+            sum += bucket[c];
+            bucket[c] = ends ? sum : sum - bucket[c];
+        }
     }
-    
-    size_t i = text.length();
-    
-    while (i > 0)
+
+    // Sorts the L-type suffixes from the LMS suffixes in sa, then the S-type
+    // suffixes from the L-type ones
+    template <typename Char>
+    static void induce(const Char* text, Index* sa, Index n, const vector<bool>& s_type,
+                       vector<Index>& bucket)
     {
-        --i;
-        size_t c = get_char_index(text[i]);
-        count[c] -= 1;
-        order[count[c]] = i;
+        bucket_ends(text, n, bucket, false);
+        // The sentinel comes first and precedes the last suffix, which is L-type
+        sa[bucket[text[n - 1]]++] = n - 1;
+        for (Index i = 0; i < n; ++i)
+        {
+            Index p = sa[i];
+            if (p != EMPTY && p > 0 && !s_type[p - 1])
+            {
+                sa[bucket[text[p - 1]]++] = p - 1;
+            }
+        }
+
+        bucket_ends(text, n, bucket, true);
+        for (Index i = n; i-- > 0; )
+        {
+            Index p = sa[i];
+            if (p != EMPTY && p > 0 && s_type[p - 1])
+            {
+                sa[--bucket[text[p - 1]]] = p - 1;
+            }
+        }
     }
-    
-    return order;
+
+    // Whether the LMS substrings at a and b, each running to the next LMS
+    // position or to the sentinel, are equal
+    template <typename Char>
+    static bool same_lms_substring(const Char* text, Index n, const vector<bool>& s_type,
+                                   Index a, Index b)
+    {
+        for (Index d = 0; ; ++d)
+        {
+            if (a + d == n || b + d == n || text[a + d] != text[b + d] ||
+                s_type[a + d] != s_type[b + d])
+            {
+                return false;
+            }
+
+            if (d > 0 && is_lms(s_type, a + d))
+            {
+                return true;
+            }
+        }
+    }
+};
+
+template <typename Index>
+const Index SuffixSorter<Index>::EMPTY;
+
+/*  Build suffix array of the string text and return a vector result of the same length
+ *  as the text such that the value result[i] is the index (0-based) in text where the
+ *  i-th lexicographically smallest suffix of text starts. Index is uint32_t for texts
+ *  shorter than 2^32 - 1 characters, which halves the memory, and uint64_t otherwise.
+ */
+template <typename Index>
+vector<Index> BuildSuffixArray(const string& text)
+{
+    vector<Index> suffix_array(text.length());
+    SuffixSorter<Index>::sort(reinterpret_cast<const unsigned char*>(text.data()),
+                              suffix_array.data(), static_cast<Index>(text.length()), 256);
+    return suffix_array;
 }
 
-// Returns the equivalence classes of the characters of text.
-vector<size_t> compute_character_classes(const string& text,
-                                         const vector<size_t>& order)
+// LCP array of Kasai et al., see suffix_array_long.cpp. rank is filled with
+// the inverse of the suffix array.
+template <typename Index>
+vector<Index> BuildLcpArray(const string& text, const vector<Index>& suffix_array,
+                            vector<Index>& rank)
 {
-    vector<size_t> classes(text.length());
-    classes[order[0]] = 0;
-    size_t current_class = 0;
-    
-    for (size_t i = 1; i < text.length(); ++i)
+    size_t n = text.length();
+    vector<Index> lcp(n > 0 ? n - 1 : 0);
+    rank.resize(n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        rank[suffix_array[i]] = static_cast<Index>(i);
+    }
+
+    size_t common = 0;
+
+    for (size_t p = 0; p < n; ++p)
     {
-        if (text[order[i]] != text[order[i - 1]])
+        size_t r = rank[p];
+
+        if (r + 1 == n)
+        {
+            common = 0;
+            continue;
+        }
+
+        size_t q = suffix_array[r + 1];
+
+        while (p + common < n && q + common < n && text[p + common] == text[q + common])
+        {
+            ++common;
+        }
+
+        lcp[r] = static_cast<Index>(common);
+
+        if (common > 0)
         {
-            ++current_class;
+            --common;
         }
-        
-        classes[order[i]] =  current_class;
     }
-    
-    return classes;
+
+    return lcp;
 }
 
-// Given ordered partial cyclic shifts, sort shifts of doubled length.
-vector<size_t> sort_doubled(const string& text,
-                            size_t length,
-                            const vector<size_t>& order,
-                            const vector<size_t>& classes)
+// Positions of leftmost minima of ranges of a fixed array. Ranges inside one
+// block of 32 entries are scanned, and longer ones combine scans of their end
+// blocks with a sparse table over block minima, which keeps the table at
+// (n / 32) log n entries.
+template <typename Index>
+class RangeMinimum
 {
-    size_t s = text.length();
-    vector<size_t> new_order(s);
-    vector<size_t> count(s, 0);
-    
-    for (size_t i = 0; i < s; ++i)
+public:
+    explicit RangeMinimum(const vector<Index>& values) : values(values)
+    {
+        size_t blocks = (values.size() + BLOCK - 1) / BLOCK;
+        table.push_back(vector<Index>(blocks));
+
+        for (size_t b = 0; b < blocks; ++b)
+        {
+            table[0][b] = scan(b * BLOCK, std::min(values.size(), (b + 1) * BLOCK));
+        }
+
+        for (size_t k = 1; (size_t(1) << k) <= blocks; ++k)
+        {
+            const vector<Index>& previous = table[k - 1];
+            size_t half = size_t(1) << (k - 1);
+            vector<Index> level(blocks - (size_t(1) << k) + 1);
+
+            for (size_t b = 0; b < level.size(); ++b)
+            {
+                level[b] = better(previous[b], previous[b + half]);
+            }
+
+            table.push_back(level);
+        }
+    }
+
+    // Position of the leftmost minimum of values[lo, hi), for lo < hi
+    Index query(size_t lo, size_t hi) const
     {
-        count[classes[i]] += 1;
+        size_t first = lo / BLOCK;
+        size_t last = (hi - 1) / BLOCK;
+
+        if (first == last)
+        {
+            return scan(lo, hi);
+        }
+
+        Index best = scan(lo, (first + 1) * BLOCK);
+
+        if (first + 1 < last)
+        {
+            size_t k = 63 - __builtin_clzll(last - first - 1);
+            best = better(best, better(table[k][first + 1], table[k][last - (size_t(1) << k)]));
+        }
+
+        return better(best, scan(last * BLOCK, hi));
     }
-    
-    for (size_t j = 1; j < s; ++j)
+
+private:
+    static const size_t BLOCK = 32;
+    const vector<Index>& values;
+    vector<vector<Index> > table;
+
+    Index better(Index a, Index b) const
     {
-        count[j] += count[j - 1];
+        return values[b] < values[a] || (values[b] == values[a] && b < a) ? b : a;
     }
-    
-    size_t i = s;
-    
-    while (i > 0)
+
+    Index scan(size_t lo, size_t hi) const
     {
-        --i;
-        size_t start = (order[i] - length + s) % s;
-        size_t cl = classes[start];
-        count[cl] -= 1;
-        new_order[count[cl]] = start;
+        size_t best = lo;
+
+        for (size_t i = lo + 1; i < hi; ++i)
+        {
+            if (values[i] < values[best])
+            {
+                best = i;
+            }
+        }
+
+        return static_cast<Index>(best);
     }
-    
-    return new_order;
-}
+};
 
-// Update the equivalence classes of ordered cyclic shifts.
-vector<size_t> update_classes(const vector<size_t>& order,
-                              const vector<size_t> classes, size_t length)
+// Suffix array with its LCP array, inverse and range minima over the LCP
+// array, which answers the queries of a suffix tree without its pointers.
+// An lcp-interval [lb, rb] of ranks stands for the internal node whose
+// suffixes they are, and its children are split at the minima of lcp[lb, rb).
+template <typename Index>
+class EnhancedSuffixArray
 {
-    size_t n = order.size();
-    vector<size_t> new_classes(n);
-    new_classes[order[0]] = 0;
-    
-    for (size_t i = 1; i < n; ++i)
+public:
+    EnhancedSuffixArray(const string& text, const vector<Index>& suffix_array)
+    : text(text), suffix_array(suffix_array), lcp(BuildLcpArray(text, suffix_array, rank)),
+      minimum(lcp) {}
+
+    // Longest common prefix of the suffixes at ranks a < b
+    size_t lcp_of_ranks(size_t a, size_t b) const
+    {
+        return b == a + 1 ? lcp[a] : lcp[minimum.query(a, b)];
+    }
+
+    // Longest common prefix of the suffixes starting at p and q
+    size_t longest_common_prefix(size_t p, size_t q) const
     {
-        size_t cur = order[i];
-        size_t prev = order[i - 1];
-        size_t mid = (cur + length) % n;
-        size_t mid_prev = (prev + length) % n;
-        
-        if (classes[cur] != classes[prev] || classes[mid] != classes[mid_prev])
+        if (p == q)
         {
-            new_classes[cur] = new_classes[prev] + 1;
+            return text.length() - p;
         }
-        else
+
+        size_t a = rank[p], b = rank[q];
+        return a < b ? lcp_of_ranks(a, b) : lcp_of_ranks(b, a);
+    }
+
+    // Longest substring occurring at least twice, as (position, length),
+    // with length 0 if no character repeats
+    pair<size_t, size_t> longest_repeat() const
+    {
+        if (lcp.empty())
         {
-            new_classes[cur] = new_classes[prev];
+            return make_pair(0, 0);
         }
+
+        size_t best = std::max_element(lcp.begin(), lcp.end()) - lcp.begin();
+        return make_pair(static_cast<size_t>(suffix_array[best]), static_cast<size_t>(lcp[best]));
     }
-    
-    return new_classes;
-}
 
-/*  Build suffix array of the string text and return a vector result of the same length
- *  as the text such that the value result[i] is the index (0-based) in text where the
- *  i-th lexicographically smallest suffix of text starts.
- */
-vector<size_t> BuildSuffixArray(const string& text)
-{
-    vector<size_t> order = sort_characters(text);
-    vector<size_t> classes = compute_character_classes(text, order);
-    size_t l = 1;
-    
-    while (l < text.length())
+    // Calls f(lb, rb) for the child intervals of the lcp-interval [lb, rb], lb < rb
+    template <typename F>
+    void for_each_child(size_t lb, size_t rb, F f) const
     {
-        order = sort_doubled(text, l, order, classes);
-        classes = update_classes(order, classes, l);
-        l = 2 * l;
+        size_t depth = lcp_of_ranks(lb, rb);
+        size_t start = lb;
+
+        while (start < rb)
+        {
+            size_t split = minimum.query(start, rb);
+
+            if (lcp[split] != depth)
+            {
+                break;
+            }
+
+            f(start, split);
+            start = split + 1;
+        }
+
+        f(start, rb);
     }
-    
-    return order;
-}
 
-// Return all the positions in text where a given pattern occurs.
-vector<size_t> FindOccurrences(const string& pattern, const string& text,
-                               const vector<size_t>& suffix_array)
-{
-    vector<size_t> result;
-    size_t min_index = 0;
-    size_t max_index = text.length();
-    
-    while (min_index < max_index)
+    // Ranks [first, last) of the suffixes starting with pattern, found with
+    // the binary search of Manber and Myers in O(m + log n): the range minima
+    // give the common prefix of the middle suffix with either end, so no
+    // character of the pattern is compared more than once per step
+    pair<size_t, size_t> find(const string& pattern) const
     {
-        size_t mid_index = (min_index + max_index) / 2;
-        string suffix = text.substr(suffix_array[mid_index], pattern.length());
-        
-        if (pattern > suffix)
+        size_t l = 0, h = 0;
+        size_t first = bound(pattern, false, -1, l, h);
+        return make_pair(first, found_range_end(pattern, first, h));
+    }
+
+    // find for each of the patterns. They are searched in sorted order, so a
+    // lower bound never lies before the previous one, and the search starts
+    // there with the characters the two patterns share known to match.
+    vector<pair<size_t, size_t> > find_all(const vector<string>& patterns) const
+    {
+        // The first 8 bytes of each pattern, packed big-endian, order most
+        // pairs without touching the strings
+        vector<pair<uint64_t, size_t> > keys(patterns.size());
+
+        for (size_t i = 0; i < keys.size(); ++i)
         {
-            min_index = mid_index + 1;
+            uint64_t key = 0;
+
+            for (size_t j = 0; j < 8; ++j)
+            {
+                key <<= 8;
+                key |= j < patterns[i].length() ? static_cast<unsigned char>(patterns[i][j]) : 0;
+            }
+
+            keys[i] = make_pair(key, i);
         }
-        else
+
+        std::sort(keys.begin(), keys.end(), [&patterns](const pair<uint64_t, size_t>& a,
+                                                        const pair<uint64_t, size_t>& b)
         {
-            max_index = mid_index;
+            return a.first != b.first ? a.first < b.first : patterns[a.second] < patterns[b.second];
+        });
+
+        vector<size_t> order(patterns.size());
+
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            order[i] = keys[i].second;
         }
+
+        vector<pair<size_t, size_t> > ranks(patterns.size());
+        size_t first = 0, common = 0;
+
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            const string& pattern = patterns[order[i]];
+
+            if (i > 0)
+            {
+                const string& previous = patterns[order[i - 1]];
+
+                if (pattern == previous)
+                {
+                    ranks[order[i]] = ranks[order[i - 1]];
+                    continue;
+                }
+
+                size_t shared = 0;
+
+                while (shared < previous.length() && shared < pattern.length() &&
+                       previous[shared] == pattern[shared])
+                {
+                    ++shared;
+                }
+
+                common = std::min(common, shared);
+            }
+
+            size_t h = 0;
+            first = bound(pattern, false, static_cast<long>(first) - 1, common, h);
+            ranks[order[i]] = make_pair(first, found_range_end(pattern, first, h));
+        }
+
+        return ranks;
     }
-    
-    size_t start = min_index;
-    max_index = text.length();
-    
-    while (min_index < max_index)
+
+    const vector<Index>& lcp_array() const
     {
-        size_t mid_index = (min_index + max_index) / 2;
-        string suffix = text.substr(suffix_array[mid_index], pattern.length());
+        return lcp;
+    }
 
-        if (pattern < suffix)
+private:
+    static const size_t SHORTCUT = 16;
+    const string& text;
+    const vector<Index>& suffix_array;
+    vector<Index> rank;
+    vector<Index> lcp;
+    RangeMinimum<Index> minimum;
+
+    // Whether the suffix at rank r sorts before pattern, given that they share
+    // their first `common` characters, which is updated to the full match.
+    // With prefix_is_less a suffix starting with pattern counts as before it.
+    bool less(size_t r, const string& pattern, size_t& common, bool prefix_is_less) const
+    {
+        size_t p = suffix_array[r];
+
+        while (common < pattern.length() && p + common < text.length() &&
+               text[p + common] == pattern[common])
         {
-            max_index = mid_index;
+            ++common;
+        }
+
+        if (common == pattern.length())
+        {
+            return prefix_is_less;
+        }
+
+        return p + common == text.length() ||
+               static_cast<unsigned char>(text[p + common]) < static_cast<unsigned char>(pattern[common]);
+    }
+
+    // End of the ranks starting with pattern, given the first of them and
+    // the common prefix of pattern with the suffix there
+    size_t found_range_end(const string& pattern, size_t first, size_t common) const
+    {
+        if (common < pattern.length())
+        {
+            return first;
+        }
+
+        size_t h = 0;
+        return bound(pattern, true, static_cast<long>(first), common, h);
+    }
+
+    // First rank after lo whose suffix does not sort before pattern. The
+    // search keeps lo before pattern and hi not before it, with l and h their
+    // common prefixes with pattern, and ranks -1 and n standing for the ends.
+    // l comes in as a lower bound for the starting lo and goes out exact for
+    // the final one, and h goes out for the rank returned. From a given lo
+    // the search gallops until it finds a hi, so searches that start near
+    // their answer take O(log distance) steps.
+    size_t bound(const string& pattern, bool prefix_is_less, long lo, size_t& l, size_t& h) const
+    {
+        long hi = static_cast<long>(text.length());
+        bool galloping = lo >= 0;
+        long step = 1;
+        h = 0;
+
+        if (lo < 0)
+        {
+            l = 0;
         }
         else
         {
-            min_index = mid_index + 1;
+            less(lo, pattern, l, prefix_is_less);
         }
+
+        while (hi - lo > 1)
+        {
+            long mid = lo + (hi - lo) / 2;
+
+            if (galloping)
+            {
+                mid = std::min(mid, lo + step);
+                step *= 2;
+            }
+
+            // Every suffix between lo and hi shares min(l, h) characters with
+            // pattern, so while l and h are close the characters past it are
+            // cheaper to compare than the range minimum that skips them.
+            size_t common = std::min(l, h);
+
+            if (l > h + SHORTCUT && lo >= 0)
+            {
+                size_t k = lcp_of_ranks(lo, mid);
+
+                if (k > l)
+                {
+                    lo = mid;
+                    continue;
+                }
+
+                if (k < l)
+                {
+                    hi = mid;
+                    h = k;
+                    galloping = false;
+                    continue;
+                }
+
+                common = l;
+            }
+            else if (h > l + SHORTCUT && hi < static_cast<long>(text.length()))
+            {
+                size_t k = lcp_of_ranks(mid, hi);
+
+                if (k > h)
+                {
+                    hi = mid;
+                    continue;
+                }
+
+                if (k < h)
+                {
+                    lo = mid;
+                    l = k;
+                    continue;
+                }
+
+                common = h;
+            }
+
+            if (less(mid, pattern, common, prefix_is_less))
+            {
+                lo = mid;
+                l = common;
+            }
+            else
+            {
+                hi = mid;
+                h = common;
+                galloping = false;
+            }
+        }
+
+        return hi;
     }
+};
+
+// Mark all the positions in text where one of the patterns occurs.
+template <typename Index>
+void FindOccurrences(const vector<string>& patterns, const vector<Index>& suffix_array,
+                     const EnhancedSuffixArray<Index>& index, vector<bool>& occurs)
+{
+    vector<pair<size_t, size_t> > ranks = index.find_all(patterns);
     
-    size_t end = max_index;
-    
-    for (size_t i = start; i < end; ++i)
+    for (size_t p = 0; p < ranks.size(); ++p)
     {
-        result.push_back(suffix_array[i]);
+        for (size_t i = ranks[p].first; i < ranks[p].second; ++i)
+        {
+            occurs[suffix_array[i]] = true;
+        }
     }
-    
-    return result;
 }
 
-int main()
+// Answers queries on the suffixes of text + '$', one per line:
+//   lcp P Q          length of the longest common prefix of the suffixes at P and Q
+//   repeat           position and length of the longest substring occurring twice
+//   children LB RB   the child intervals of the lcp-interval [LB, RB] of ranks
+template <typename Index>
+void AnswerQueries(const EnhancedSuffixArray<Index>& index, size_t n)
 {
+    int query_count;
+    cin >> query_count;
+
+    for (int i = 0; i < query_count; ++i)
+    {
+        string type;
+        cin >> type;
+
+        if (type == "lcp")
+        {
+            size_t p, q;
+            cin >> p >> q;
+
+            if (p < n && q < n)
+            {
+                cout << index.longest_common_prefix(p, q) << '\n';
+                continue;
+            }
+        }
+        else if (type == "repeat")
+        {
+            pair<size_t, size_t> repeat = index.longest_repeat();
+            cout << repeat.first << ' ' << repeat.second << '\n';
+            continue;
+        }
+        else if (type == "children")
+        {
+            size_t lb, rb;
+            cin >> lb >> rb;
+
+            if (lb < rb && rb < n)
+            {
+                index.for_each_child(lb, rb, [](size_t child_lb, size_t child_rb)
+                {
+                    cout << child_lb << ' ' << child_rb << ' ';
+                });
+                cout << '\n';
+                continue;
+            }
+        }
+
+        cout << "invalid\n";
+    }
+}
+
+// Usage: suffix_array_matching [--query]
+int main(int argc, char** argv)
+{
+    if (argc > 1 && string(argv[1]) == "--query")
+    {
+        string text;
+        cin >> text;
+        text += '$';
+        vector<uint32_t> suffix_array = BuildSuffixArray<uint32_t>(text);
+        EnhancedSuffixArray<uint32_t> index(text, suffix_array);
+        AnswerQueries(index, text.length());
+        return 0;
+    }
+
     char buffer[100001];
     scanf("%s", buffer);
     
     string text = buffer;
     text += '$';
-    vector<size_t> suffix_array = BuildSuffixArray(text);
+    vector<uint32_t> suffix_array = BuildSuffixArray<uint32_t>(text);
+    EnhancedSuffixArray<uint32_t> index(text, suffix_array);
     
     int pattern_count;
     
     scanf("%d", &pattern_count);
     
-    vector<bool> occurs(text.length(), false);
+    vector<string> patterns(pattern_count);
     
     for (int pattern_index = 0; pattern_index < pattern_count; ++pattern_index)
     {
         scanf("%s", buffer);
-        string pattern = buffer;
-        vector<size_t> occurrences = FindOccurrences(pattern, text, suffix_array);
-        
-        for (int j = 0; j < occurrences.size(); ++j)
-        {
-            occurs[occurrences[j]] = true;
-        }
+        patterns[pattern_index] = buffer;
     }
     
+    vector<bool> occurs(text.length(), false);
+    FindOccurrences(patterns, suffix_array, index, occurs);
+    
     for (int i = 0; i < occurs.size(); ++i)
     {
         if (occurs[i]) {
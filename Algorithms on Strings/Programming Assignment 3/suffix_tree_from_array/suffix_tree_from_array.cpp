@@ -172,6 +172,51 @@ SuffixTree SuffixTreeFromSuffixArray( const vector<int>& suffix_array,
     return tree;
 }
 
+// LCP array of Kasai et al., see suffix_array_long.cpp. rank is filled with
+// the inverse of the suffix array.
+template <typename Index>
+vector<Index> BuildLcpArray(const string& text, const vector<Index>& suffix_array,
+                            vector<Index>& rank)
+{
+    size_t n = text.length();
+    vector<Index> lcp(n > 0 ? n - 1 : 0);
+    rank.resize(n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        rank[suffix_array[i]] = static_cast<Index>(i);
+    }
+
+    size_t common = 0;
+
+    for (size_t p = 0; p < n; ++p)
+    {
+        size_t r = rank[p];
+
+        if (r + 1 == n)
+        {
+            common = 0;
+            continue;
+        }
+
+        size_t q = suffix_array[r + 1];
+
+        while (p + common < n && q + common < n && text[p + common] == text[q + common])
+        {
+            ++common;
+        }
+
+        lcp[r] = static_cast<Index>(common);
+
+        if (common > 0)
+        {
+            --common;
+        }
+    }
+
+    return lcp;
+}
+
 int main()
 {
     char buffer[200001];
@@ -184,11 +229,20 @@ int main()
         scanf("%d", &suffix_array[i]);
     }
     
+    // The LCP array may be left out of the input, in which case it is
+    // computed from the text and the suffix array.
     vector<int> lcp_array(text.length() - 1);
+    bool has_lcp = true;
+    
+    for (size_t i = 0; i + 1 < text.length() && has_lcp; ++i)
+    {
+        has_lcp = scanf("%d", &lcp_array[i]) == 1;
+    }
     
-    for (int i = 0; i + 1 < text.length(); ++i)
+    if (!has_lcp)
     {
-        scanf("%d", &lcp_array[i]);
+        vector<int> rank;
+        lcp_array = BuildLcpArray(text, suffix_array, rank);
     }
     
     // Build the suffix tree and get a mapping from
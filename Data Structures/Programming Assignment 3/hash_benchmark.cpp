@@ -0,0 +1,231 @@
+/**
+ *  hash_benchmark.cpp
+ *  Data Structures: Programming Assignment 3
+ *
+ *  Compares the string hashes of hash_chains.cpp: hashes per second, full
+ *  64-bit collisions between distinct keys, and the longest chain when the
+ *  keys are spread over as many buckets as there are keys.
+ *
+ *  Usage: hash_benchmark [keys]
+ **/
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <chrono>
+
+using std::string;
+using std::vector;
+
+// The hashes from hash_chains.cpp
+// Seed shared by the hashes of this process, so that inputs built to collide
+// under one run do not collide under the next.
+uint64_t process_seed() {
+    static const uint64_t seed = []() {
+        std::random_device device;
+        uint64_t seed = (static_cast<uint64_t>(device()) << 32) ^ device();
+        return seed ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }();
+    return seed;
+}
+
+// The string hashes share one interface: hash(s, n) hashes n bytes at s. The
+// polynomial ones are sum s[i] * x^i modulo a prime, and also expose mul, add
+// and sub modulo that prime, power(n) = x^n and the digit of a character, so
+// that a hash can be rolled along a text.
+
+// Polynomial hash modulo 1000000007. Seed 0 gives the multiplier 263 used by
+// the assignments, any other seed a random multiplier.
+class PolyHash {
+    static const uint64_t PRIME = 1000000007;
+    uint64_t x;
+    
+public:
+    explicit PolyHash(uint64_t seed = 0) : x(seed == 0 ? 263 : 2 + seed % (PRIME - 3)) {}
+    
+    uint64_t mul(uint64_t a, uint64_t b) const { return a * b % PRIME; }
+    uint64_t add(uint64_t a, uint64_t b) const { return (a + b) % PRIME; }
+    uint64_t sub(uint64_t a, uint64_t b) const { return (a + PRIME - b) % PRIME; }
+    uint64_t multiplier() const { return x; }
+    uint64_t digit(char c) const { return static_cast<unsigned char>(c); }
+    
+    uint64_t power(size_t n) const {
+        uint64_t result = 1;
+        for (size_t i = 0; i < n; ++i)
+            result = mul(result, x);
+        return result;
+    }
+    
+    uint64_t hash(const char* s, size_t n) const {
+        uint64_t result = 0;
+        for (size_t i = n; i-- > 0; )
+            result = (result * x + digit(s[i])) % PRIME;
+        return result;
+    }
+};
+
+// Polynomial hash modulo the Mersenne prime 2^61 - 1, where the reduction is a
+// shift and an add instead of a division. The multiplier comes from the seed.
+class MersenneHash {
+    static const uint64_t PRIME = (1ULL << 61) - 1;
+    uint64_t x;
+    
+    static uint64_t reduce(uint64_t a) {
+        a = (a & PRIME) + (a >> 61);
+        return a >= PRIME ? a - PRIME : a;
+    }
+    
+public:
+    explicit MersenneHash(uint64_t seed) : x((1ULL << 32) + seed % (PRIME - (1ULL << 33))) {}
+    
+    uint64_t mul(uint64_t a, uint64_t b) const {
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        uint64_t low = static_cast<uint64_t>(product) & PRIME;
+        uint64_t high = static_cast<uint64_t>(product >> 61);
+        return reduce(low + high);
+    }
+    uint64_t add(uint64_t a, uint64_t b) const { return reduce(a + b); }
+    uint64_t sub(uint64_t a, uint64_t b) const { return reduce(a + PRIME - b); }
+    uint64_t multiplier() const { return x; }
+    uint64_t digit(char c) const { return static_cast<unsigned char>(c); }
+    
+    uint64_t power(size_t n) const {
+        uint64_t result = 1, base = x;
+        for (; n; n >>= 1, base = mul(base, base))
+            if (n & 1)
+                result = mul(result, base);
+        return result;
+    }
+    
+    uint64_t hash(const char* s, size_t n) const {
+        // Kept below 2^62 by a single fold per character and reduced at the end
+        uint64_t result = 0;
+        for (size_t i = n; i-- > 0; ) {
+            unsigned __int128 product = static_cast<unsigned __int128>(result) * x;
+            uint64_t sum = (static_cast<uint64_t>(product) & PRIME) + static_cast<uint64_t>(product >> 61) + digit(s[i]);
+            result = (sum & PRIME) + (sum >> 61);
+        }
+        return reduce(result);
+    }
+};
+
+// Non-cryptographic hash taking 8 bytes per step, and 32 bytes per step in four
+// independent lanes on long strings. Every step folds the 128-bit product of
+// the state and the input word into 64 bits. It cannot be rolled, so it is for
+// hash tables rather than for Rabin-Karp.
+class WideHash {
+    static const uint64_t K0 = 0xa0761d6478bd642fULL;
+    static const uint64_t K1 = 0xe7037ed1a0b428dbULL;
+    static const uint64_t K2 = 0x8ebc6af09c88c6e3ULL;
+    static const uint64_t K3 = 0x589965cc75374cc3ULL;
+    uint64_t seed;
+    
+    static uint64_t fold(uint64_t a, uint64_t b) {
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+    }
+    
+    static uint64_t word(const char* s) {
+        uint64_t w;
+        memcpy(&w, s, sizeof(w));
+        return w;
+    }
+    
+public:
+    explicit WideHash(uint64_t seed) : seed(fold(seed ^ K0, K1)) {}
+    
+    uint64_t hash(const char* s, size_t n) const {
+        uint64_t h = seed ^ n;
+        size_t i = 0;
+        if (n >= 32) {
+            uint64_t a = h ^ K0, b = h ^ K1, c = h ^ K2, d = h ^ K3;
+            for (; i + 32 <= n; i += 32) {
+                a = fold(word(s + i) ^ K0, word(s + i + 8) ^ a);
+                b = fold(word(s + i + 8) ^ K1, word(s + i + 16) ^ b);
+                c = fold(word(s + i + 16) ^ K2, word(s + i + 24) ^ c);
+                d = fold(word(s + i + 24) ^ K3, word(s + i) ^ d);
+            }
+            h = fold(a ^ c, b ^ d ^ K0);
+        }
+        for (; i + 8 <= n; i += 8)
+            h = fold(word(s + i) ^ K1, h ^ K2);
+        if (i < n) {
+            uint64_t tail = 0;
+            memcpy(&tail, s + i, n - i);
+            h = fold(tail ^ K3, h ^ K0);
+        }
+        return fold(h ^ K1, n ^ K2);
+    }
+};
+
+// Distinct random keys with lengths in [min_length, max_length]
+vector<string> random_keys(size_t count, size_t min_length, size_t max_length, std::mt19937_64& rng) {
+    std::uniform_int_distribution<size_t> length(min_length, max_length);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    vector<string> keys(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys[i].resize(length(rng));
+        for (size_t j = 0; j < keys[i].size(); ++j)
+            keys[i][j] = static_cast<char>(letter(rng));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+// Keys that differ only in a counter at the end, like generated identifiers
+vector<string> sequential_keys(size_t count) {
+    vector<string> keys(count);
+    char buffer[32];
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(buffer, sizeof(buffer), "user%09zu", i);
+        keys[i] = buffer;
+    }
+    return keys;
+}
+
+template <typename Hash>
+void report(const char* name, const Hash& hasher, const vector<string>& keys) {
+    vector<uint64_t> hashes(keys.size());
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        hashes[i] = hasher.hash(keys[i].data(), keys[i].size());
+        bytes += keys[i].size();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    vector<uint32_t> chain(keys.size(), 0);
+    uint32_t longest = 0;
+    for (size_t i = 0; i < keys.size(); ++i)
+        longest = std::max(longest, ++chain[hashes[i] % keys.size()]);
+    std::sort(hashes.begin(), hashes.end());
+    size_t collisions = 0;
+    for (size_t i = 1; i < hashes.size(); ++i)
+        collisions += hashes[i] == hashes[i - 1];
+
+    printf("  %-14s %8.1f Mhash/s %8.2f GB/s %10zu collisions %6u longest chain\n",
+           name, keys.size() / seconds / 1e6, bytes / seconds / 1e9, collisions, longest);
+}
+
+void run(const char* title, const vector<string>& keys) {
+    uint64_t seed = process_seed();
+    printf("%s: %zu keys\n", title, keys.size());
+    report("poly (263)", PolyHash(), keys);
+    report("poly (seeded)", PolyHash(seed), keys);
+    report("mersenne", MersenneHash(seed), keys);
+    report("wide", WideHash(seed), keys);
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    std::mt19937_64 rng(12345);
+    run("short keys", random_keys(count, 1, 15, rng));
+    run("long keys", random_keys(count / 10, 64, 256, rng));
+    run("sequential keys", sequential_keys(count));
+    return 0;
+}
@@ -8,12 +8,18 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <list>
 #include <algorithm>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <random>
+#include <chrono>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using std::string;
 using std::vector;
-using std::list;
 using std::cin;
 
 struct Query {
@@ -21,70 +27,433 @@ struct Query {
     size_t ind;
 };
 
-struct Chain {
-    list<string> elems;
+// Seed shared by the hashes of this process, so that inputs built to collide
+// under one run do not collide under the next.
+uint64_t process_seed() {
+    static const uint64_t seed = []() {
+        std::random_device device;
+        uint64_t seed = (static_cast<uint64_t>(device()) << 32) ^ device();
+        return seed ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }();
+    return seed;
+}
+
+// The string hashes share one interface: hash(s, n) hashes n bytes at s. The
+// polynomial ones are sum s[i] * x^i modulo a prime, and also expose mul, add
+// and sub modulo that prime, power(n) = x^n and the digit of a character, so
+// that a hash can be rolled along a text.
+
+// Polynomial hash modulo 1000000007. Seed 0 gives the multiplier 263 used by
+// the assignments, any other seed a random multiplier.
+class PolyHash {
+    static const uint64_t PRIME = 1000000007;
+    uint64_t x;
     
-    string to_string() const {
-        string res = "";
-        for (list<string>::const_iterator it = elems.begin(); it != elems.end(); it++) {
-            if (! res.empty()) {
-                res += " ";
-            }
-            res += *it;
+public:
+    explicit PolyHash(uint64_t seed = 0) : x(seed == 0 ? 263 : 2 + seed % (PRIME - 3)) {}
+    
+    uint64_t mul(uint64_t a, uint64_t b) const { return a * b % PRIME; }
+    uint64_t add(uint64_t a, uint64_t b) const { return (a + b) % PRIME; }
+    uint64_t sub(uint64_t a, uint64_t b) const { return (a + PRIME - b) % PRIME; }
+    uint64_t multiplier() const { return x; }
+    uint64_t digit(char c) const { return static_cast<unsigned char>(c); }
+    
+    uint64_t power(size_t n) const {
+        uint64_t result = 1;
+        for (size_t i = 0; i < n; ++i)
+            result = mul(result, x);
+        return result;
+    }
+    
+    uint64_t hash(const char* s, size_t n) const {
+        uint64_t result = 0;
+        for (size_t i = n; i-- > 0; )
+            result = (result * x + digit(s[i])) % PRIME;
+        return result;
+    }
+};
+
+// Polynomial hash modulo the Mersenne prime 2^61 - 1, where the reduction is a
+// shift and an add instead of a division. The multiplier comes from the seed.
+class MersenneHash {
+    static const uint64_t PRIME = (1ULL << 61) - 1;
+    uint64_t x;
+    
+    static uint64_t reduce(uint64_t a) {
+        a = (a & PRIME) + (a >> 61);
+        return a >= PRIME ? a - PRIME : a;
+    }
+    
+public:
+    explicit MersenneHash(uint64_t seed) : x((1ULL << 32) + seed % (PRIME - (1ULL << 33))) {}
+    
+    uint64_t mul(uint64_t a, uint64_t b) const {
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        uint64_t low = static_cast<uint64_t>(product) & PRIME;
+        uint64_t high = static_cast<uint64_t>(product >> 61);
+        return reduce(low + high);
+    }
+    uint64_t add(uint64_t a, uint64_t b) const { return reduce(a + b); }
+    uint64_t sub(uint64_t a, uint64_t b) const { return reduce(a + PRIME - b); }
+    uint64_t multiplier() const { return x; }
+    uint64_t digit(char c) const { return static_cast<unsigned char>(c); }
+    
+    uint64_t power(size_t n) const {
+        uint64_t result = 1, base = x;
+        for (; n; n >>= 1, base = mul(base, base))
+            if (n & 1)
+                result = mul(result, base);
+        return result;
+    }
+    
+    uint64_t hash(const char* s, size_t n) const {
+        // Kept below 2^62 by a single fold per character and reduced at the end
+        uint64_t result = 0;
+        for (size_t i = n; i-- > 0; ) {
+            unsigned __int128 product = static_cast<unsigned __int128>(result) * x;
+            uint64_t sum = (static_cast<uint64_t>(product) & PRIME) + static_cast<uint64_t>(product >> 61) + digit(s[i]);
+            result = (sum & PRIME) + (sum >> 61);
         }
-        return res;
+        return reduce(result);
+    }
+};
+
+// Non-cryptographic hash taking 8 bytes per step, and 32 bytes per step in four
+// independent lanes on long strings. Every step folds the 128-bit product of
+// the state and the input word into 64 bits. It cannot be rolled, so it is for
+// hash tables rather than for Rabin-Karp.
+class WideHash {
+    static const uint64_t K0 = 0xa0761d6478bd642fULL;
+    static const uint64_t K1 = 0xe7037ed1a0b428dbULL;
+    static const uint64_t K2 = 0x8ebc6af09c88c6e3ULL;
+    static const uint64_t K3 = 0x589965cc75374cc3ULL;
+    uint64_t seed;
+    
+    static uint64_t fold(uint64_t a, uint64_t b) {
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
     }
     
-    void add(const string& str) {
-        bool exists = false;
-        for (list<string>::iterator it = elems.begin(); it != elems.end(); it++) {
-            if (str == *it) {
-                exists = true;
-                break;
+    static uint64_t word(const char* s) {
+        uint64_t w;
+        memcpy(&w, s, sizeof(w));
+        return w;
+    }
+    
+public:
+    explicit WideHash(uint64_t seed) : seed(fold(seed ^ K0, K1)) {}
+    
+    uint64_t hash(const char* s, size_t n) const {
+        uint64_t h = seed ^ n;
+        size_t i = 0;
+        if (n >= 32) {
+            uint64_t a = h ^ K0, b = h ^ K1, c = h ^ K2, d = h ^ K3;
+            for (; i + 32 <= n; i += 32) {
+                a = fold(word(s + i) ^ K0, word(s + i + 8) ^ a);
+                b = fold(word(s + i + 8) ^ K1, word(s + i + 16) ^ b);
+                c = fold(word(s + i + 16) ^ K2, word(s + i + 24) ^ c);
+                d = fold(word(s + i + 24) ^ K3, word(s + i) ^ d);
             }
+            h = fold(a ^ c, b ^ d ^ K0);
+        }
+        for (; i + 8 <= n; i += 8)
+            h = fold(word(s + i) ^ K1, h ^ K2);
+        if (i < n) {
+            uint64_t tail = 0;
+            memcpy(&tail, s + i, n - i);
+            h = fold(tail ^ K3, h ^ K0);
+        }
+        return fold(h ^ K1, n ^ K2);
+    }
+};
+
+// A string kept inside its node when it is short, which saves an allocation
+// per key for the short keys of the usual workloads.
+class SmallString {
+    static const size_t INLINE_SIZE = 20;
+    uint32_t size_;
+    char inline_[INLINE_SIZE];
+    std::unique_ptr<char[]> heap_;
+    
+public:
+    SmallString() : size_(0), inline_() {}
+    
+    void assign(const string& str) {
+        size_ = static_cast<uint32_t>(str.size());
+        if (str.size() > INLINE_SIZE) {
+            heap_.reset(new char[str.size()]);
+        }
+        memcpy(heap_ ? heap_.get() : inline_, str.data(), str.size());
+    }
+    
+    void clear() {
+        size_ = 0;
+        heap_.reset();
+    }
+    
+    const char* data() const {
+        return heap_ ? heap_.get() : inline_;
+    }
+    
+    bool equals(const string& str) const {
+        return str.size() == size_ && memcmp(data(), str.data(), size_) == 0;
+    }
+    
+    string str() const {
+        return string(data(), size_);
+    }
+};
+
+// A set of strings with open addressing in the style of SwissTable. Every slot
+// has a control byte that marks it empty or deleted or holds 7 bits of the hash
+// of its key, and the 16 control bytes of a group are matched against a key at
+// once. The slots point to nodes holding the keys with their full hashes, so
+// that a probe only compares strings whose hashes are equal. The nodes are also
+// linked into the chains given by hash % chain_count, newest first, which keeps
+// the contents of a chain available for the "check" query.
+class StringTable {
+    static const int8_t EMPTY = -128;
+    static const int8_t DELETED = -2;
+    static const size_t GROUP_SIZE = 16;
+    static const int32_t NONE = -1;
+    
+    struct Node {
+        SmallString key;
+        uint64_t hash;
+        int32_t prev, next;
+    };
+    
+    // Bit i is set for the control bytes of the group at ctrl that match
+    class Group {
+#ifdef __SSE2__
+        __m128i ctrl;
+        
+    public:
+        explicit Group(const int8_t* pos) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+        
+        uint32_t match(int8_t h2) const {
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2)));
+        }
+        
+        uint32_t match_empty() const {
+            return match(EMPTY);
+        }
+        
+        // Empty or deleted slots are the ones with the sign bit set
+        uint32_t match_free() const {
+            return _mm_movemask_epi8(ctrl);
         }
-        if (!exists) {
-            elems.push_front(str);
+#else
+        const int8_t* ctrl;
+        
+    public:
+        explicit Group(const int8_t* pos) : ctrl(pos) {}
+        
+        uint32_t match(int8_t h2) const {
+            uint32_t mask = 0;
+            for (size_t i = 0; i < GROUP_SIZE; ++i)
+                mask |= static_cast<uint32_t>(ctrl[i] == h2) << i;
+            return mask;
         }
+        
+        uint32_t match_empty() const {
+            return match(EMPTY);
+        }
+        
+        uint32_t match_free() const {
+            uint32_t mask = 0;
+            for (size_t i = 0; i < GROUP_SIZE; ++i)
+                mask |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+            return mask;
+        }
+#endif
+    };
+    
+    vector<int8_t> ctrl;
+    vector<int32_t> slots;
+    size_t group_mask;
+    size_t size;
+    size_t deleted;
+    
+    vector<Node> nodes;
+    vector<int32_t> free_nodes;
+    vector<int32_t> chain_head;
+    
+    // Spreads the hash over 64 bits, the probe starts from the high bits and
+    // the control byte takes the low 7 bits
+    static uint64_t mix(uint64_t hash) {
+        uint64_t h = hash;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+    
+    size_t capacity() const {
+        return ctrl.size();
     }
     
-    void erase(const string& str) {
-        for (list<string>::iterator it = elems.begin(); it != elems.end(); it++) {
-            if (str == *it) {
-                elems.erase(it);
-                break;
+    // Slot holding str, or -1
+    long find_slot(const string& str, uint64_t hash) const {
+        uint64_t h = mix(hash);
+        int8_t h2 = static_cast<int8_t>(h & 0x7f);
+        size_t g = (h >> 7) & group_mask;
+        for (size_t step = 1; ; g = (g + step++) & group_mask) {
+            Group group(&ctrl[g * GROUP_SIZE]);
+            for (uint32_t match = group.match(h2); match; match &= match - 1) {
+                size_t slot = g * GROUP_SIZE + __builtin_ctz(match);
+                const Node& node = nodes[slots[slot]];
+                if (node.hash == hash && node.key.equals(str)) {
+                    return slot;
+                }
+            }
+            if (group.match_empty()) {
+                return -1;
             }
         }
     }
     
-    string find(const string& str) const{
-        for (list<string>::const_iterator it = elems.begin(); it != elems.end(); it++) {
-            if (str == *it) {
-                return "yes";
+    // First empty or deleted slot on the probe sequence of hash
+    size_t free_slot(uint64_t hash) const {
+        size_t g = (mix(hash) >> 7) & group_mask;
+        for (size_t step = 1; ; g = (g + step++) & group_mask) {
+            uint32_t match = Group(&ctrl[g * GROUP_SIZE]).match_free();
+            if (match) {
+                return g * GROUP_SIZE + __builtin_ctz(match);
             }
         }
-        return "no";
     }
     
+    void place(size_t slot, int32_t node) {
+        if (ctrl[slot] == DELETED) {
+            --deleted;
+        }
+        ctrl[slot] = static_cast<int8_t>(mix(nodes[node].hash) & 0x7f);
+        slots[slot] = node;
+    }
+    
+    // Rebuilds the slots with room for at least the given number of keys
+    // under the maximum load factor of 7/8, dropping the deleted slots
+    void rehash(size_t keys) {
+        size_t groups = 1;
+        while (groups * GROUP_SIZE * 7 / 8 < keys) {
+            groups *= 2;
+        }
+        vector<int8_t> old_ctrl(groups * GROUP_SIZE, EMPTY);
+        vector<int32_t> old_slots(groups * GROUP_SIZE);
+        old_ctrl.swap(ctrl);
+        old_slots.swap(slots);
+        group_mask = groups - 1;
+        deleted = 0;
+        for (size_t i = 0; i < old_ctrl.size(); ++i) {
+            if (old_ctrl[i] >= 0) {
+                place(free_slot(nodes[old_slots[i]].hash), old_slots[i]);
+            }
+        }
+    }
+    
+    int32_t new_node(const string& str, uint64_t hash) {
+        int32_t id;
+        if (free_nodes.empty()) {
+            id = static_cast<int32_t>(nodes.size());
+            nodes.push_back(Node());
+        } else {
+            id = free_nodes.back();
+            free_nodes.pop_back();
+        }
+        Node& node = nodes[id];
+        node.key.assign(str);
+        node.hash = hash;
+        // Newest first in its chain
+        int32_t& head = chain_head[hash % chain_head.size()];
+        node.prev = NONE;
+        node.next = head;
+        if (head != NONE) {
+            nodes[head].prev = id;
+        }
+        head = id;
+        return id;
+    }
+    
+    void delete_node(int32_t id) {
+        Node& node = nodes[id];
+        if (node.prev != NONE) {
+            nodes[node.prev].next = node.next;
+        } else {
+            chain_head[node.hash % chain_head.size()] = node.next;
+        }
+        if (node.next != NONE) {
+            nodes[node.next].prev = node.prev;
+        }
+        node.key.clear();
+        free_nodes.push_back(id);
+    }
+    
+public:
+    explicit StringTable(size_t chain_count) : ctrl(GROUP_SIZE, EMPTY), slots(GROUP_SIZE),
+    group_mask(0), size(0), deleted(0), chain_head(chain_count, NONE) {}
+    
+    // Adds str unless it is present already
+    void add(const string& str, uint64_t hash) {
+        if (find_slot(str, hash) >= 0) {
+            return;
+        }
+        if ((size + deleted + 1) > capacity() * 7 / 8) {
+            // Grow if most of the used slots hold keys, otherwise just clear out the deleted ones
+            rehash(size + 1 > capacity() * 7 / 16 ? 2 * (size + 1) : size + 1);
+        }
+        place(free_slot(hash), new_node(str, hash));
+        ++size;
+    }
+    
+    void erase(const string& str, uint64_t hash) {
+        long slot = find_slot(str, hash);
+        if (slot < 0) {
+            return;
+        }
+        delete_node(slots[slot]);
+        ctrl[slot] = DELETED;
+        ++deleted;
+        --size;
+    }
+    
+    bool find(const string& str, uint64_t hash) const {
+        return find_slot(str, hash) >= 0;
+    }
+    
+    // The keys of the given chain, newest first
+    string chain_to_string(size_t chain) const {
+        string res = "";
+        for (int32_t id = chain_head[chain]; id != NONE; id = nodes[id].next) {
+            if (! res.empty()) {
+                res += " ";
+            }
+            res += nodes[id].key.str();
+        }
+        return res;
+    }
 };
 
+const int8_t StringTable::EMPTY;
+const int8_t StringTable::DELETED;
+const size_t StringTable::GROUP_SIZE;
+const int32_t StringTable::NONE;
+
+// Hash is one of the hashes above. The bucket of a string, which decides the
+// output of "check", is its hash modulo bucket_count.
+template <typename Hash>
 class QueryProcessor {
-    int bucket_count;
-    // implement chains;
-    vector<Chain> elems;
+    Hash hasher;
+    StringTable elems;
     
-    size_t hash_func(const string& s) const {
-        static const size_t multiplier = 263;
-        static const size_t prime = 1000000007;
-        unsigned long long hash = 0;
-        for (int i = static_cast<int> (s.size()) - 1; i >= 0; --i)
-            hash = (hash * multiplier + s[i]) % prime;
-        return hash % bucket_count;
+    uint64_t full_hash(const string& s) const {
+        return hasher.hash(s.data(), s.size());
     }
     
 public:
-    explicit QueryProcessor(int bucket_count) : bucket_count(bucket_count),
-    elems(vector<Chain>(bucket_count)) {}
+    QueryProcessor(int bucket_count, const Hash& hasher) : hasher(hasher), elems(bucket_count) {}
     
     Query readQuery() const {
         Query query;
@@ -102,15 +471,15 @@ public:
     
     void processQuery(const Query& query) {
         if (query.type == "check") {
-            std::cout << elems[query.ind].to_string() << std::endl;
+            std::cout << elems.chain_to_string(query.ind) << "\n";
         } else {
-            Chain* chain = &elems[hash_func(query.s)];
+            uint64_t hash = full_hash(query.s);
             if (query.type == "add") {
-                chain->add(query.s);
+                elems.add(query.s, hash);
             } else if (query.type == "del") {
-                chain->erase(query.s);
+                elems.erase(query.s, hash);
             } else if (query.type == "find") {
-                std::cout << chain->find(query.s) << std::endl;
+                writeSearchResult(elems.find(query.s, hash));
             }
         }
     }
@@ -183,12 +552,25 @@ public:
     }
 };
 
-int main() {
+// Usage: hash_chains [--hash poly|mersenne|wide]
+// The default is the polynomial hash of the assignment, whose buckets the
+// expected "check" output is based on. The other hashes are seeded per process.
+int main(int argc, char** argv) {
     std::ios_base::sync_with_stdio(false);
+    string hash = "poly";
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (string(argv[i]) == "--hash") {
+            hash = argv[++i];
+        }
+    }
     int bucket_count;
     cin >> bucket_count;
-    QueryProcessor proc(bucket_count);
-    proc.processQueries();
+    if (hash == "mersenne") {
+        QueryProcessor<MersenneHash>(bucket_count, MersenneHash(process_seed())).processQueries();
+    } else if (hash == "wide") {
+        QueryProcessor<WideHash>(bucket_count, WideHash(process_seed())).processQueries();
+    } else {
+        QueryProcessor<PolyHash>(bucket_count, PolyHash()).processQueries();
+    }
     return 0;
 }
-
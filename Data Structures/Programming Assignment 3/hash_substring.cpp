@@ -9,11 +9,23 @@
 #include <string>
 #include <vector>
 #include <cstdlib>
-#include <ctime>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <atomic>
+#include <thread>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using std::string;
 using std::vector;
-typedef unsigned long long ull;
 
 struct Data {
     string pattern, text;
@@ -31,57 +43,334 @@ void print_occurrences(const std::vector<size_t>& output) {
     std::cout << "\n";
 }
 
-ull poly_hash(const string& s, ull p, ull x) {
-    ull hash = 0;
-    for (int i = static_cast<int> (s.size()) - 1; i >= 0; --i) {
-        hash = ((hash * x + s[i]) % p + p) % p;
-    }
-    return hash;
+// Seed shared by the hashes of this process, so that inputs built to collide
+// under one run do not collide under the next.
+uint64_t process_seed() {
+    static const uint64_t seed = []() {
+        std::random_device device;
+        uint64_t seed = (static_cast<uint64_t>(device()) << 32) ^ device();
+        return seed ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }();
+    return seed;
 }
 
-vector<ull> precomputeHashes(const string& text, size_t pattern_length,
-                             ull prime, ull x) {
-    vector<ull> hashes(text.length() - pattern_length + 1);
-    string s = text.substr(text.length() - pattern_length);
-    hashes[text.length() - pattern_length] = poly_hash(s, prime, x);
-    ull y = 1;
-    for (size_t i = 0; i < pattern_length; i++) {
-        y = ((y * x) % prime + prime) % prime;
-    }
-    for (int i = static_cast<int>(text.length() - pattern_length) - 1; i >= 0; --i) {
-        hashes[i] = (
-                     (
-                      (x * hashes[i + 1]) % prime
-                      + text[i] % prime
-                      - (y * text[i + pattern_length]) % prime
-                      ) + prime
-                     ) % prime;
+// The string hashes share one interface: hash(s, n) hashes n bytes at s. The
+// polynomial ones are sum s[i] * x^i modulo a prime, and also expose mul, add
+// and sub modulo that prime, power(n) = x^n and the digit of a character, so
+// that a hash can be rolled along a text.
+
+// Polynomial hash modulo 1000000007. Seed 0 gives the multiplier 263 used by
+// the assignments, any other seed a random multiplier.
+class PolyHash {
+    static const uint64_t PRIME = 1000000007;
+    uint64_t x;
+    
+public:
+    explicit PolyHash(uint64_t seed = 0) : x(seed == 0 ? 263 : 2 + seed % (PRIME - 3)) {}
+    
+    uint64_t mul(uint64_t a, uint64_t b) const { return a * b % PRIME; }
+    uint64_t add(uint64_t a, uint64_t b) const { return (a + b) % PRIME; }
+    uint64_t sub(uint64_t a, uint64_t b) const { return (a + PRIME - b) % PRIME; }
+    uint64_t multiplier() const { return x; }
+    uint64_t digit(char c) const { return static_cast<unsigned char>(c); }
+    
+    uint64_t power(size_t n) const {
+        uint64_t result = 1;
+        for (size_t i = 0; i < n; ++i)
+            result = mul(result, x);
+        return result;
+    }
+    
+    uint64_t hash(const char* s, size_t n) const {
+        uint64_t result = 0;
+        for (size_t i = n; i-- > 0; )
+            result = (result * x + digit(s[i])) % PRIME;
+        return result;
+    }
+};
+
+// Polynomial hash modulo the Mersenne prime 2^61 - 1, where the reduction is a
+// shift and an add instead of a division. The multiplier comes from the seed.
+class MersenneHash {
+    static const uint64_t PRIME = (1ULL << 61) - 1;
+    uint64_t x;
+    
+    static uint64_t reduce(uint64_t a) {
+        a = (a & PRIME) + (a >> 61);
+        return a >= PRIME ? a - PRIME : a;
+    }
+    
+public:
+    explicit MersenneHash(uint64_t seed) : x((1ULL << 32) + seed % (PRIME - (1ULL << 33))) {}
+    
+    uint64_t mul(uint64_t a, uint64_t b) const {
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        uint64_t low = static_cast<uint64_t>(product) & PRIME;
+        uint64_t high = static_cast<uint64_t>(product >> 61);
+        return reduce(low + high);
+    }
+    uint64_t add(uint64_t a, uint64_t b) const { return reduce(a + b); }
+    uint64_t sub(uint64_t a, uint64_t b) const { return reduce(a + PRIME - b); }
+    uint64_t multiplier() const { return x; }
+    uint64_t digit(char c) const { return static_cast<unsigned char>(c); }
+    
+    uint64_t power(size_t n) const {
+        uint64_t result = 1, base = x;
+        for (; n; n >>= 1, base = mul(base, base))
+            if (n & 1)
+                result = mul(result, base);
+        return result;
+    }
+    
+    uint64_t hash(const char* s, size_t n) const {
+        // Kept below 2^62 by a single fold per character and reduced at the end
+        uint64_t result = 0;
+        for (size_t i = n; i-- > 0; ) {
+            unsigned __int128 product = static_cast<unsigned __int128>(result) * x;
+            uint64_t sum = (static_cast<uint64_t>(product) & PRIME) + static_cast<uint64_t>(product >> 61) + digit(s[i]);
+            result = (sum & PRIME) + (sum >> 61);
+        }
+        return reduce(result);
+    }
+};
+
+template <typename Hash>
+vector<uint64_t> precomputeHashes(const string& text, size_t pattern_length,
+                                  const Hash& hasher) {
+    size_t last = text.length() - pattern_length;
+    vector<uint64_t> hashes(last + 1);
+    hashes[last] = hasher.hash(text.data() + last, pattern_length);
+    uint64_t x = hasher.multiplier();
+    uint64_t y = hasher.power(pattern_length);
+    for (int i = static_cast<int>(last) - 1; i >= 0; --i) {
+        hashes[i] = hasher.sub(hasher.add(hasher.mul(x, hashes[i + 1]), hasher.digit(text[i])),
+                               hasher.mul(y, hasher.digit(text[i + pattern_length])));
     }
     return hashes;
 }
 
-vector<size_t> get_occurrences(const Data& input) {
-    // Implements Rabin-Karp algorithm
+// Whether the n bytes at a and b are equal, comparing 16 bytes at a time
+inline bool same_bytes(const char* a, const char* b, size_t n) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xffff)
+            return false;
+    }
+#endif
+    for (; i < n; ++i)
+        if (a[i] != b[i])
+            return false;
+    return true;
+}
+
+// Rabin-Karp with one of the polynomial hashes above
+template <typename Hash>
+vector<size_t> get_occurrences(const Data& input, const Hash& hasher) {
     std::vector<size_t> res;
-    srand((unsigned int) time(NULL));
-    ull prime = 1000000007;
-    ull x = (rand() + 1) % (prime - 1);
-    ull hash = poly_hash(input.pattern, prime, x);
     size_t pattern_length = input.pattern.length();
     size_t text_length = input.text.length();
-    vector<ull> hashes = precomputeHashes(input.text, pattern_length,
-                                          prime, x);
+    if (pattern_length > text_length) {
+        return res;
+    }
+    uint64_t hash = hasher.hash(input.pattern.data(), pattern_length);
+    vector<uint64_t> hashes = precomputeHashes(input.text, pattern_length, hasher);
     for (size_t i = 0; i <= text_length - pattern_length; i++) {
         if (hash == hashes[i] &&
-            input.text.substr(i, pattern_length) == input.pattern) {
+            same_bytes(input.text.data() + i, input.pattern.data(), pattern_length)) {
             res.push_back(i);
         }
     }
     return res;
 }
 
-int main() {
+// prefix[i] = hash of the first i characters of s, in the forward convention
+// sum s[i] * x^(n - 1 - i), so that the hash of s[i, i + m) is
+// prefix[i + m] - prefix[i] * x^m.
+template <typename Hash>
+void prefix_hashes(const Hash& hasher, const char* s, size_t n, vector<uint64_t>& prefix) {
+    prefix.resize(n + 1);
+    prefix[0] = 0;
+    uint64_t x = hasher.multiplier();
+    for (size_t i = 0; i < n; ++i)
+        prefix[i + 1] = hasher.add(hasher.mul(prefix[i], x), hasher.digit(s[i]));
+}
+
+// Rabin-Karp for many patterns at once. The patterns are grouped by length,
+// and every window of the text is hashed once per length and looked up among
+// the patterns of that length. Two independent Mersenne hashes must both match
+// before a candidate is confirmed with same_bytes().
+//
+// The text is cut into chunks of start positions that are scanned in parallel.
+// A chunk hashes its own piece of the text, extended by the longest pattern
+// minus one, so that matches crossing its end are found by the chunk they start in.
+class MultiPatternMatcher {
+    static const size_t CHUNK = 1 << 20;
+    
+    // The patterns of one length
+    struct Group {
+        size_t length;
+        // x^length for both hashes
+        uint64_t power[2];
+        // First hash -> patterns with it
+        std::unordered_map<uint64_t, vector<int> > by_hash;
+        // Bit (first hash & filter_mask) is set for the first hashes in by_hash,
+        // which rejects most windows without a lookup
+        vector<uint64_t> filter;
+        uint64_t filter_mask;
+        
+        bool may_contain(uint64_t hash) const {
+            uint64_t bit = hash & filter_mask;
+            return filter[bit >> 6] >> (bit & 63) & 1;
+        }
+    };
+    
+    vector<string> patterns;
+    vector<uint64_t> second_hash;
+    MersenneHash hashers[2];
+    vector<Group> groups;
+    size_t max_length;
+    
+    // Appends the matches starting in [begin, end) to out
+    void scan(const string& text, size_t begin, size_t end, vector<std::pair<size_t, int> >& out) const {
+        size_t piece = std::min(text.size(), end + max_length - 1) - begin;
+        vector<uint64_t> prefix[2];
+        for (int k = 0; k < 2; ++k)
+            prefix_hashes(hashers[k], text.data() + begin, piece, prefix[k]);
+        for (size_t i = 0; i < end - begin; ++i) {
+            for (const Group& group : groups) {
+                if (i + group.length > piece)
+                    break;
+                uint64_t first = hashers[0].sub(prefix[0][i + group.length],
+                                                hashers[0].mul(prefix[0][i], group.power[0]));
+                if (!group.may_contain(first))
+                    continue;
+                auto it = group.by_hash.find(first);
+                if (it == group.by_hash.end())
+                    continue;
+                uint64_t second = hashers[1].sub(prefix[1][i + group.length],
+                                                 hashers[1].mul(prefix[1][i], group.power[1]));
+                for (int id : it->second) {
+                    if (second_hash[id] == second &&
+                        same_bytes(text.data() + begin + i, patterns[id].data(), group.length)) {
+                        out.push_back(std::make_pair(begin + i, id));
+                    }
+                }
+            }
+        }
+    }
+    
+public:
+    // Empty patterns never match
+    MultiPatternMatcher(const vector<string>& patterns, uint64_t seed)
+    : patterns(patterns), second_hash(patterns.size()),
+    hashers{MersenneHash(seed), MersenneHash(seed ^ 0x9e3779b97f4a7c15ULL)}, max_length(1) {
+        vector<int> order;
+        for (size_t id = 0; id < patterns.size(); ++id)
+            if (!patterns[id].empty())
+                order.push_back(static_cast<int>(id));
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return patterns[a].size() < patterns[b].size();
+        });
+        vector<uint64_t> prefix;
+        for (int id : order) {
+            const string& pattern = patterns[id];
+            if (groups.empty() || groups.back().length != pattern.size()) {
+                groups.push_back(Group());
+                groups.back().length = pattern.size();
+                for (int k = 0; k < 2; ++k)
+                    groups.back().power[k] = hashers[k].power(pattern.size());
+                max_length = pattern.size();
+            }
+            prefix_hashes(hashers[0], pattern.data(), pattern.size(), prefix);
+            groups.back().by_hash[prefix.back()].push_back(id);
+            prefix_hashes(hashers[1], pattern.data(), pattern.size(), prefix);
+            second_hash[id] = prefix.back();
+        }
+        // About 64 bits per distinct hash
+        for (Group& group : groups) {
+            size_t bits = 64;
+            while (bits < 64 * group.by_hash.size())
+                bits *= 2;
+            group.filter.assign(bits / 64, 0);
+            group.filter_mask = bits - 1;
+            for (const auto& entry : group.by_hash)
+                group.filter[(entry.first & group.filter_mask) >> 6] |= 1ULL << (entry.first & 63);
+        }
+    }
+    
+    // All occurrences as (offset, pattern index), ordered by offset and then by pattern
+    vector<std::pair<size_t, int> > find_all(const string& text, int threads) const {
+        size_t chunks = (text.size() + CHUNK - 1) / CHUNK;
+        vector<vector<std::pair<size_t, int> > > found(chunks);
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t c = next++; c < chunks; c = next++) {
+                scan(text, c * CHUNK, std::min(text.size(), (c + 1) * CHUNK), found[c]);
+                std::sort(found[c].begin(), found[c].end());
+            }
+        };
+        vector<std::thread> pool;
+        for (int t = 1; t < threads && static_cast<size_t>(t) < chunks; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (size_t t = 0; t < pool.size(); ++t)
+            pool[t].join();
+        
+        vector<std::pair<size_t, int> > res;
+        for (size_t c = 0; c < chunks; ++c)
+            res.insert(res.end(), found[c].begin(), found[c].end());
+        return res;
+    }
+};
+
+// Usage: hash_substring [--hash poly|mersenne]
+//        hash_substring --patterns FILE [--threads N]
+// The first form reads a pattern and a text and prints where the pattern
+// occurs, with either hash taking a random multiplier per process. The second
+// reads one pattern per line of FILE and scans all of the standard input for
+// them, printing "offset pattern" for every occurrence, with the patterns
+// numbered from 0 in the order of the file.
+int main(int argc, char** argv) {
     std::ios_base::sync_with_stdio(false);
-    print_occurrences(get_occurrences(read_input()));
+    string hash = "mersenne";
+    string patterns_file;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i + 1 < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--hash") {
+            hash = argv[++i];
+        } else if (arg == "--patterns") {
+            patterns_file = argv[++i];
+        } else if (arg == "--threads") {
+            threads = std::max(1, atoi(argv[++i]));
+        }
+    }
+    
+    if (!patterns_file.empty()) {
+        std::ifstream in(patterns_file.c_str());
+        if (!in) {
+            std::cerr << "Cannot open " << patterns_file << "\n";
+            return 1;
+        }
+        vector<string> patterns;
+        for (string line; std::getline(in, line); )
+            patterns.push_back(line);
+        string text((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+        MultiPatternMatcher matcher(patterns, process_seed());
+        vector<std::pair<size_t, int> > found = matcher.find_all(text, threads);
+        for (size_t i = 0; i < found.size(); ++i)
+            std::cout << found[i].first << " " << found[i].second << "\n";
+        return 0;
+    }
+    
+    Data input = read_input();
+    if (hash == "poly") {
+        print_occurrences(get_occurrences(input, PolyHash(process_seed())));
+    } else {
+        print_occurrences(get_occurrences(input, MersenneHash(process_seed())));
+    }
     return 0;
 }